@@ -0,0 +1,73 @@
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+using namespace std;
+
+// Blocking queue with a fixed capacity between one producer and one consumer.
+// The producer calls Close when done, the consumer calls Cancel to stop the producer early.
+template <typename T>
+class BoundedQueue
+{
+    private:
+        deque<T> _items;
+        size_t _capacity;
+        bool _closed;
+        bool _cancelled;
+        mutex _mutex;
+        condition_variable _notFull;
+        condition_variable _notEmpty;
+
+    public:
+        BoundedQueue(size_t capacity) : _capacity(capacity), _closed(false), _cancelled(false)
+        {
+        }
+
+        // Block while the queue is full, return false if the consumer cancelled the queue.
+        bool Push(T item)
+        {
+            unique_lock<mutex> lock(_mutex);
+            _notFull.wait(lock, [this] { return _items.size() < _capacity || _cancelled; });
+            if (_cancelled)
+            {
+                return false;
+            }
+
+            _items.push_back(move(item));
+            _notEmpty.notify_one();
+            return true;
+        }
+
+        // Block while the queue is empty, return false once the queue is closed and drained or cancelled.
+        bool Pop(T* item)
+        {
+            unique_lock<mutex> lock(_mutex);
+            _notEmpty.wait(lock, [this] { return !_items.empty() || _closed || _cancelled; });
+            if (_cancelled || _items.empty())
+            {
+                return false;
+            }
+
+            *item = move(_items.front());
+            _items.pop_front();
+            _notFull.notify_one();
+            return true;
+        }
+
+        void Close()
+        {
+            lock_guard<mutex> lock(_mutex);
+            _closed = true;
+            _notEmpty.notify_all();
+        }
+
+        void Cancel()
+        {
+            lock_guard<mutex> lock(_mutex);
+            _cancelled = true;
+            _items.clear();
+            _notFull.notify_all();
+            _notEmpty.notify_all();
+        }
+};
@@ -0,0 +1,85 @@
+#include "ConversionStatistics.h"
+#include <algorithm>
+#include <climits>
+#include "ParquetOptions.h"
+
+// Exponential moving average, the first sample initializes the average.
+static double MovingAverage(double average, double sample, bool isFirstSample)
+{
+    return isFirstSample ? sample : average + ParquetOptions::StatisticsSmoothingFactor * (sample - average);
+}
+
+void ConversionStatisticsTracker::Record(const string& schemaKey, long long inputBytes, long long rows, long long outputBytes, double parseSeconds, double encodeSeconds)
+{
+    if (rows <= 0)
+    {
+        return;
+    }
+
+    lock_guard<mutex> lock(_mutex);
+    auto itr = _statistics.find(schemaKey);
+    const bool isFirstSample = itr == _statistics.end();
+    ConversionStatistics& statistics = _statistics[schemaKey];
+    if (isFirstSample)
+    {
+        statistics = ConversionStatistics();
+    }
+
+    statistics.InputBytesPerRow = MovingAverage(statistics.InputBytesPerRow, static_cast<double>(inputBytes) / rows, isFirstSample);
+    statistics.OutputBytesPerRow = MovingAverage(statistics.OutputBytesPerRow, static_cast<double>(outputBytes) / rows, isFirstSample);
+
+    // Conversions too fast to time do not update throughput.
+    if (parseSeconds > 0)
+    {
+        statistics.ParseBytesPerSecond = MovingAverage(statistics.ParseBytesPerSecond, inputBytes / parseSeconds, statistics.ParseBytesPerSecond == 0);
+    }
+
+    if (encodeSeconds > 0)
+    {
+        statistics.EncodeRowsPerSecond = MovingAverage(statistics.EncodeRowsPerSecond, rows / encodeSeconds, statistics.EncodeRowsPerSecond == 0);
+    }
+
+    statistics.ConversionCount++;
+}
+
+bool ConversionStatisticsTracker::Get(const string& schemaKey, ConversionStatistics* statistics)
+{
+    lock_guard<mutex> lock(_mutex);
+    auto itr = _statistics.find(schemaKey);
+    if (itr == _statistics.end())
+    {
+        return false;
+    }
+
+    *statistics = itr->second;
+    return true;
+}
+
+bool ConversionStatisticsTracker::RecommendBatchSize(const string& schemaKey, long long targetOutputBytes, int targetLatencyMilliseconds, int pipelineChunkSize, long long* inputBytes, long long* rows)
+{
+    ConversionStatistics statistics;
+    if (!Get(schemaKey, &statistics))
+    {
+        return false;
+    }
+
+    double recommendedRows = targetOutputBytes / max(statistics.OutputBytesPerRow, 1.0);
+    if (targetLatencyMilliseconds > 0 && statistics.ParseBytesPerSecond > 0 && statistics.EncodeRowsPerSecond > 0)
+    {
+        const double parseSecondsPerRow = statistics.InputBytesPerRow / statistics.ParseBytesPerSecond;
+        const double encodeSecondsPerRow = 1 / statistics.EncodeRowsPerSecond;
+        double latencyRows = targetLatencyMilliseconds / 1000.0 / (parseSecondsPerRow + encodeSecondsPerRow);
+        if (latencyRows * statistics.InputBytesPerRow > pipelineChunkSize)
+        {
+            latencyRows = targetLatencyMilliseconds / 1000.0 / max(parseSecondsPerRow, encodeSecondsPerRow);
+        }
+
+        recommendedRows = min(recommendedRows, latencyRows);
+    }
+
+    // Input length of a single conversion is an int.
+    recommendedRows = max(1.0, min(recommendedRows, INT_MAX / max(statistics.InputBytesPerRow, 1.0)));
+    *rows = static_cast<long long>(recommendedRows);
+    *inputBytes = static_cast<long long>(recommendedRows * statistics.InputBytesPerRow);
+    return true;
+}
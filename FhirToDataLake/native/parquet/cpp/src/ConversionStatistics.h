@@ -0,0 +1,35 @@
+#pragma once
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+using namespace std;
+
+// Moving averages of the conversions of one schema key, shared with callers through the C interface.
+struct ConversionStatistics
+{
+    long long ConversionCount;
+    double InputBytesPerRow;
+    double OutputBytesPerRow;
+    double ParseBytesPerSecond;
+    double EncodeRowsPerSecond;
+};
+
+// Track conversion cost per schema key, so callers can size input batches for well-sized parquet outputs.
+class ConversionStatisticsTracker
+{
+    private:
+        mutex _mutex;
+        unordered_map<string, ConversionStatistics> _statistics;
+
+    public:
+        void Record(const string& schemaKey, long long inputBytes, long long rows, long long outputBytes, double parseSeconds, double encodeSeconds);
+
+        // Return false if no conversion of schemaKey has been recorded.
+        bool Get(const string& schemaKey, ConversionStatistics* statistics);
+
+        // Recommend an input batch that produces about targetOutputBytes and, when targetLatencyMilliseconds is positive,
+        // converts within that latency. Inputs above pipelineChunkSize overlap parsing and encoding, so their latency is the slower
+        // of the two phases. Return false if no conversion of schemaKey has been recorded.
+        bool RecommendBatchSize(const string& schemaKey, long long targetOutputBytes, int targetLatencyMilliseconds, int pipelineChunkSize, long long* inputBytes, long long* rows);
+};
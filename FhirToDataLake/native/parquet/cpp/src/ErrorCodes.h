@@ -9,8 +9,24 @@ enum ErrorCodes : int
     ReadInputJsonError = 10001,
     // Error when converting to parquet.
     WriteToParquetError = 10002,
+    // Error when converting to arrow IPC bytes or arrow C stream.
+    WriteToArrowError = 10003,
+    // Error reading input parquet data for compaction.
+    ReadInputParquetError = 10004,
     // Error when parsing schema files.
     ParseParquetSchemaError = 11001,
     // Specfied schema file (for resource) not found.
     SchemaNotFound = 11002,
+    // Async conversion job was cancelled before it finished.
+    ConversionCancelled = 12001,
+    // Async conversion was rejected because the in-flight limit is reached.
+    TooManyInFlightConversions = 12002,
+    // Async conversion job not found, it may have already finished.
+    ConversionJobNotFound = 12003,
+    // No conversion of the schema key has been recorded yet.
+    ConversionStatisticsNotFound = 13001,
+    // Encryption keys are invalid for the schema.
+    InvalidEncryptionKeys = 14001,
+    // Page checksums are not supported by the arrow version the library is built with.
+    PageChecksumNotSupported = 14002,
 };
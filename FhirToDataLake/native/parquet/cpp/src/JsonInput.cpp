@@ -0,0 +1,362 @@
+#include "JsonInput.h"
+#include <cctype>
+#include <cstring>
+#include <functional>
+#include <vector>
+
+// Structural scanner over json bytes. Only the containers around the resources are walked, the resources themselves
+// are copied as they are and validated later by the arrow json parser.
+class JsonScanner
+{
+    private:
+        const char* _start;
+        const char* _position;
+        const char* _end;
+        string* _error;
+
+    public:
+        JsonScanner(const char* inputJson, int inputLength, string* error)
+        {
+            _start = inputJson;
+            _position = inputJson;
+            _end = inputJson + inputLength;
+            _error = error;
+        }
+
+        const char* Position() const
+        {
+            return _position;
+        }
+
+        bool Fail(const string& message)
+        {
+            *_error = message + " at offset " + to_string(_position - _start) + ".";
+            return false;
+        }
+
+        void SkipWhitespace()
+        {
+            while (_position < _end && isspace(static_cast<unsigned char>(*_position)))
+            {
+                _position++;
+            }
+        }
+
+        bool TryConsume(char c)
+        {
+            SkipWhitespace();
+            if (_position < _end && *_position == c)
+            {
+                _position++;
+                return true;
+            }
+
+            return false;
+        }
+
+        bool Expect(char c)
+        {
+            return TryConsume(c) || Fail(string("Expected '") + c + "'");
+        }
+
+        bool ExpectEnd()
+        {
+            SkipWhitespace();
+            return _position == _end || Fail("Unexpected data after json");
+        }
+
+        // Scan a string, value is the raw content between the quotes and may be null.
+        bool ScanString(string* value)
+        {
+            if (!Expect('"'))
+            {
+                return false;
+            }
+
+            const char* valueStart = _position;
+            while (_position < _end && *_position != '"')
+            {
+                _position += *_position == '\\' ? 2 : 1;
+            }
+
+            if (_position >= _end)
+            {
+                _position = _end;
+                return Fail("Unterminated string");
+            }
+
+            if (value != nullptr)
+            {
+                value->assign(valueStart, _position);
+            }
+
+            _position++;
+            return true;
+        }
+
+        // Skip a value of any type, only the nesting of containers is checked.
+        bool SkipValue()
+        {
+            vector<char> closers;
+            do
+            {
+                SkipWhitespace();
+                if (_position == _end)
+                {
+                    return Fail("Unexpected end of json");
+                }
+
+                const char c = *_position;
+                if (c == '"')
+                {
+                    if (!ScanString(nullptr))
+                    {
+                        return false;
+                    }
+                }
+                else if (c == '{' || c == '[')
+                {
+                    closers.push_back(c == '{' ? '}' : ']');
+                    _position++;
+                }
+                else if (c == '}' || c == ']' || c == ',' || c == ':')
+                {
+                    if (closers.empty() || ((c == '}' || c == ']') && closers.back() != c))
+                    {
+                        return Fail(string("Unexpected '") + c + "'");
+                    }
+
+                    if (c == closers.back())
+                    {
+                        closers.pop_back();
+                    }
+
+                    _position++;
+                }
+                else
+                {
+                    // Number, true, false or null. memchr rather than strchr, which would match a NUL byte with the terminator.
+                    const char* tokenStart = _position;
+                    while (_position < _end && !isspace(static_cast<unsigned char>(*_position)) && memchr(",:{}[]\"", *_position, 7) == nullptr)
+                    {
+                        _position++;
+                    }
+
+                    if (_position == tokenStart)
+                    {
+                        return Fail("Unexpected character");
+                    }
+                }
+            } while (!closers.empty());
+
+            return true;
+        }
+
+        // Scan an object, onMember is called after each key and must consume the member value.
+        bool ScanObject(const function<bool(const string&)>& onMember)
+        {
+            if (!Expect('{'))
+            {
+                return false;
+            }
+
+            if (TryConsume('}'))
+            {
+                return true;
+            }
+
+            do
+            {
+                string key;
+                if (!ScanString(&key) || !Expect(':') || !onMember(key))
+                {
+                    return false;
+                }
+            } while (TryConsume(','));
+
+            return Expect('}');
+        }
+
+        // Scan the members of an object until key is found, then read its string value. The rest of the object is not scanned.
+        bool FindStringMember(const string& key, string* value)
+        {
+            if (!Expect('{'))
+            {
+                return false;
+            }
+
+            if (!TryConsume('}'))
+            {
+                do
+                {
+                    string memberKey;
+                    if (!ScanString(&memberKey) || !Expect(':'))
+                    {
+                        return false;
+                    }
+
+                    if (memberKey == key)
+                    {
+                        return ScanString(value);
+                    }
+
+                    if (!SkipValue())
+                    {
+                        return false;
+                    }
+                } while (TryConsume(','));
+            }
+
+            return Fail("Member '" + key + "' not found");
+        }
+
+        // Scan an array, onElement is called for each element and must consume it.
+        bool ScanArray(const function<bool()>& onElement)
+        {
+            if (!Expect('['))
+            {
+                return false;
+            }
+
+            if (TryConsume(']'))
+            {
+                return true;
+            }
+
+            do
+            {
+                if (!onElement())
+                {
+                    return false;
+                }
+            } while (TryConsume(','));
+
+            return Expect(']');
+        }
+};
+
+// Raw line breaks in valid json can only be whitespace between tokens, so replacing them keeps each value on one line.
+static void AppendLine(string* ndjson, const char* valueStart, const char* valueEnd)
+{
+    const size_t lineStart = ndjson->size();
+    ndjson->append(valueStart, valueEnd);
+    for (size_t i = lineStart; i < ndjson->size(); i++)
+    {
+        if ((*ndjson)[i] == '\n' || (*ndjson)[i] == '\r')
+        {
+            (*ndjson)[i] = ' ';
+        }
+    }
+
+    ndjson->push_back('\n');
+}
+
+bool JsonArrayToNdjson(const char* inputJson, int inputLength, string* ndjson, string* error)
+{
+    JsonScanner scanner(inputJson, inputLength, error);
+    ndjson->reserve(inputLength);
+    bool scanned = scanner.ScanArray([&]()
+    {
+        scanner.SkipWhitespace();
+        const char* elementStart = scanner.Position();
+        if (!scanner.SkipValue())
+        {
+            return false;
+        }
+
+        AppendLine(ndjson, elementStart, scanner.Position());
+        return true;
+    });
+
+    return scanned && scanner.ExpectEnd();
+}
+
+static bool ScanBundleResource(JsonScanner& scanner, map<string, string>* ndjsonByResourceType)
+{
+    scanner.SkipWhitespace();
+    const char* resourceStart = scanner.Position();
+    string resourceType;
+    bool scanned = scanner.ScanObject([&](const string& key)
+    {
+        return key == "resourceType" ? scanner.ScanString(&resourceType) : scanner.SkipValue();
+    });
+
+    if (!scanned)
+    {
+        return false;
+    }
+
+    if (resourceType.empty())
+    {
+        return scanner.Fail("Bundle entry resource has no resourceType");
+    }
+
+    AppendLine(&(*ndjsonByResourceType)[resourceType], resourceStart, scanner.Position());
+    return true;
+}
+
+bool BundleToNdjson(const char* inputJson, int inputLength, map<string, string>* ndjsonByResourceType, string* error)
+{
+    JsonScanner scanner(inputJson, inputLength, error);
+    bool scanned = scanner.ScanObject([&](const string& key)
+    {
+        if (key == "resourceType")
+        {
+            string resourceType;
+            return scanner.ScanString(&resourceType) && (resourceType == "Bundle" || scanner.Fail("Expected a Bundle but found '" + resourceType + "'"));
+        }
+
+        if (key != "entry")
+        {
+            return scanner.SkipValue();
+        }
+
+        return scanner.ScanArray([&]()
+        {
+            return scanner.ScanObject([&](const string& entryKey)
+            {
+                return entryKey == "resource" ? ScanBundleResource(scanner, ndjsonByResourceType) : scanner.SkipValue();
+            });
+        });
+    });
+
+    return scanned && scanner.ExpectEnd();
+}
+
+bool SplitNdjsonByResourceType(const char* inputJson, int inputLength, map<string, string>* ndjsonByResourceType, string* error)
+{
+    // Lines of one type are usually adjacent, so the buffer of the previous line is reused without a map lookup.
+    const char* inputEnd = inputJson + inputLength;
+    const char* lineStart = inputJson;
+    string lineResourceType;
+    string* ndjson = nullptr;
+    string resourceType;
+    while (lineStart < inputEnd)
+    {
+        const void* lineBreak = memchr(lineStart, '\n', inputEnd - lineStart);
+        const char* lineEnd = lineBreak == nullptr ? inputEnd : static_cast<const char*>(lineBreak);
+        JsonScanner scanner(lineStart, static_cast<int>(lineEnd - lineStart), error);
+        scanner.SkipWhitespace();
+        if (scanner.Position() != lineEnd)
+        {
+            if (!scanner.FindStringMember("resourceType", &resourceType))
+            {
+                *error = "Line at offset " + to_string(lineStart - inputJson) + ": " + *error;
+                return false;
+            }
+
+            if (ndjson == nullptr || resourceType != lineResourceType)
+            {
+                lineResourceType = resourceType;
+                ndjson = &(*ndjsonByResourceType)[resourceType];
+            }
+
+            ndjson->append(lineStart, lineEnd);
+            ndjson->push_back('\n');
+        }
+
+        lineStart = lineEnd + 1;
+    }
+
+    return true;
+}
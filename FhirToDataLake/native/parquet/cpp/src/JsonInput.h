@@ -0,0 +1,27 @@
+#pragma once
+#include <map>
+#include <string>
+
+using namespace std;
+
+// Layout of the input json of a conversion.
+enum InputFormat : int
+{
+    // One resource per line.
+    Ndjson = 0,
+    // A json array of resources.
+    JsonArray = 1,
+    // A FHIR Bundle, resources are read from entry[].resource.
+    Bundle = 2,
+    // One resource per line, lines are routed by their resourceType.
+    MixedNdjson = 3,
+};
+
+// Copy the elements of a json array to ndjson, one element per line.
+bool JsonArrayToNdjson(const char* inputJson, int inputLength, string* ndjson, string* error);
+
+// Copy the entry[].resource objects of a FHIR Bundle to ndjson grouped by their resourceType, entries without a resource are skipped.
+bool BundleToNdjson(const char* inputJson, int inputLength, map<string, string>* ndjsonByResourceType, string* error);
+
+// Copy the lines of ndjson grouped by the resourceType of each line, blank lines are skipped.
+bool SplitNdjsonByResourceType(const char* inputJson, int inputLength, map<string, string>* ndjsonByResourceType, string* error);
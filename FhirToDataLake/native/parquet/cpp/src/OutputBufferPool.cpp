@@ -0,0 +1,256 @@
+#include "OutputBufferPool.h"
+#include <algorithm>
+#include <cstring>
+
+mutex OutputBufferPool::_outputsMutex;
+unordered_map<byte*, pair<OutputBufferPool*, int64_t>> OutputBufferPool::_outputs;
+
+OutputBufferPool::OutputBufferPool()
+{
+    _idleBytes = 0;
+    _allocationCount = 0;
+    _reuseCount = 0;
+}
+
+// Outputs still held by callers outlive the pool, they are freed when released.
+OutputBufferPool::~OutputBufferPool()
+{
+    {
+        lock_guard<mutex> outputsLock(_outputsMutex);
+        for (auto& output : _outputs)
+        {
+            if (output.second.first == this)
+            {
+                output.second.first = nullptr;
+            }
+        }
+    }
+
+    for (auto& buffer : _idleBuffers)
+    {
+        delete[] buffer.first;
+    }
+}
+
+byte* OutputBufferPool::Acquire(int64_t minimumSize, int64_t* capacity)
+{
+    lock_guard<mutex> lock(_mutex);
+    auto selected = _idleBuffers.end();
+    for (auto itr = _idleBuffers.begin(); itr != _idleBuffers.end(); itr++)
+    {
+        if (itr->second >= minimumSize && (selected == _idleBuffers.end() || itr->second < selected->second))
+        {
+            selected = itr;
+        }
+    }
+
+    byte* data;
+    if (selected != _idleBuffers.end())
+    {
+        data = selected->first;
+        *capacity = selected->second;
+        _idleBuffers.erase(selected);
+        _idleBytes -= *capacity;
+        _reuseCount++;
+    }
+    else
+    {
+        int64_t recentMaximum = _recentOutputSizes.empty() ? 0 : *max_element(_recentOutputSizes.begin(), _recentOutputSizes.end());
+        *capacity = max(minimumSize, recentMaximum + recentMaximum / 4);
+        data = new byte[*capacity];
+        _allocationCount++;
+    }
+
+    _acquiredBuffers[data] = *capacity;
+    return data;
+}
+
+bool OutputBufferPool::Release(byte* data)
+{
+    lock_guard<mutex> lock(_mutex);
+    auto acquired = _acquiredBuffers.find(data);
+    if (acquired == _acquiredBuffers.end())
+    {
+        return false;
+    }
+
+    const int64_t capacity = acquired->second;
+    _acquiredBuffers.erase(acquired);
+    AddIdleBuffer(data, capacity);
+    return true;
+}
+
+// Keep the largest buffers when there are more idle buffers than the pool size, then free the largest ones while the idle bytes
+// are above the cap, so one large conversion does not pin its buffers for the lifetime of the writer. The caller holds _mutex.
+void OutputBufferPool::AddIdleBuffer(byte* data, int64_t capacity)
+{
+    const auto byCapacity = [](const pair<byte*, int64_t>& a, const pair<byte*, int64_t>& b) { return a.second < b.second; };
+    _idleBuffers.push_back(make_pair(data, capacity));
+    _idleBytes += capacity;
+    if (_idleBuffers.size() > static_cast<size_t>(ParquetOptions::OutputBufferPoolSize))
+    {
+        auto smallest = min_element(_idleBuffers.begin(), _idleBuffers.end(), byCapacity);
+        _idleBytes -= smallest->second;
+        delete[] smallest->first;
+        _idleBuffers.erase(smallest);
+    }
+
+    while (_idleBytes > ParquetOptions::OutputBufferPoolMaxIdleBytes)
+    {
+        auto largest = max_element(_idleBuffers.begin(), _idleBuffers.end(), byCapacity);
+        _idleBytes -= largest->second;
+        delete[] largest->first;
+        _idleBuffers.erase(largest);
+    }
+}
+
+void OutputBufferPool::DetachOutput(byte* data)
+{
+    lock_guard<mutex> outputsLock(_outputsMutex);
+    lock_guard<mutex> lock(_mutex);
+    auto acquired = _acquiredBuffers.find(data);
+    if (acquired != _acquiredBuffers.end())
+    {
+        _outputs[data] = make_pair(this, acquired->second);
+        _acquiredBuffers.erase(acquired);
+    }
+}
+
+bool OutputBufferPool::ReleaseOutput(byte* data)
+{
+    lock_guard<mutex> outputsLock(_outputsMutex);
+    auto output = _outputs.find(data);
+    if (output == _outputs.end())
+    {
+        return false;
+    }
+
+    OutputBufferPool* pool = output->second.first;
+    const int64_t capacity = output->second.second;
+    _outputs.erase(output);
+    if (pool == this)
+    {
+        lock_guard<mutex> lock(_mutex);
+        AddIdleBuffer(data, capacity);
+    }
+    else
+    {
+        delete[] data;
+    }
+
+    return true;
+}
+
+void OutputBufferPool::FreeOutput(byte* data)
+{
+    {
+        lock_guard<mutex> outputsLock(_outputsMutex);
+        _outputs.erase(data);
+    }
+
+    delete[] data;
+}
+
+void OutputBufferPool::RecordOutputSize(int64_t outputSize)
+{
+    lock_guard<mutex> lock(_mutex);
+    _recentOutputSizes.push_back(outputSize);
+    if (_recentOutputSizes.size() > static_cast<size_t>(ParquetOptions::OutputBufferPoolSize))
+    {
+        _recentOutputSizes.pop_front();
+    }
+}
+
+int64_t OutputBufferPool::ExpectedOutputSize()
+{
+    lock_guard<mutex> lock(_mutex);
+    if (_recentOutputSizes.empty())
+    {
+        return ParquetOptions::InitialOutputBufferSize;
+    }
+
+    return *max_element(_recentOutputSizes.begin(), _recentOutputSizes.end());
+}
+
+int64_t OutputBufferPool::AllocationCount()
+{
+    lock_guard<mutex> lock(_mutex);
+    return _allocationCount;
+}
+
+int64_t OutputBufferPool::ReuseCount()
+{
+    lock_guard<mutex> lock(_mutex);
+    return _reuseCount;
+}
+
+PooledOutputStream::PooledOutputStream(OutputBufferPool* pool)
+{
+    _pool = pool;
+    _data = _pool->Acquire(_pool->ExpectedOutputSize(), &_capacity);
+    _position = 0;
+    _closed = false;
+}
+
+// Return the buffer to the pool if it was never detached, e.g. when the write failed.
+PooledOutputStream::~PooledOutputStream()
+{
+    if (_data != nullptr)
+    {
+        _pool->Release(_data);
+    }
+}
+
+arrow::Status PooledOutputStream::Reserve(int64_t size)
+{
+    if (size <= _capacity)
+    {
+        return arrow::Status::OK();
+    }
+
+    int64_t newCapacity;
+    byte* newData = _pool->Acquire(max(size, _capacity * 2), &newCapacity);
+    memcpy(newData, _data, _position);
+    _pool->Release(_data);
+    _data = newData;
+    _capacity = newCapacity;
+    return arrow::Status::OK();
+}
+
+arrow::Status PooledOutputStream::Write(const void* data, int64_t nbytes)
+{
+    if (_closed)
+    {
+        return arrow::Status::IOError("Pooled output stream is closed.");
+    }
+
+    ARROW_RETURN_NOT_OK(Reserve(_position + nbytes));
+    memcpy(_data + _position, data, nbytes);
+    _position += nbytes;
+    return arrow::Status::OK();
+}
+
+arrow::Status PooledOutputStream::Close()
+{
+    _closed = true;
+    return arrow::Status::OK();
+}
+
+arrow::Result<int64_t> PooledOutputStream::Tell() const
+{
+    return _position;
+}
+
+bool PooledOutputStream::closed() const
+{
+    return _closed;
+}
+
+void PooledOutputStream::Detach(byte** outputData, int* outputSize)
+{
+    _pool->RecordOutputSize(_position);
+    _pool->DetachOutput(_data);
+    *outputData = _data;
+    *outputSize = static_cast<int>(_position);
+    _data = nullptr;
+}
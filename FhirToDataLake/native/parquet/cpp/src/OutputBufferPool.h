@@ -0,0 +1,89 @@
+#pragma once
+#include <arrow/api.h>
+#include <arrow/io/api.h>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "ParquetOptions.h"
+
+using namespace std;
+
+typedef unsigned char byte;
+
+// Reusable output byte arrays of a writer. Outputs handed to callers are tracked in a process wide registry until they are
+// returned with ReleaseOutput or freed with FreeOutput, which are the only ways to free an output. An output freed with plain
+// delete[] stays registered, and a later allocation at its address would be taken for the output.
+class OutputBufferPool
+{
+    private:
+        // Outputs handed to callers with their pool and capacity, the pool is null once it is destroyed.
+        static mutex _outputsMutex;
+        static unordered_map<byte*, pair<OutputBufferPool*, int64_t>> _outputs;
+
+        mutex _mutex;
+        // Idle buffers and their capacities.
+        vector<pair<byte*, int64_t>> _idleBuffers;
+        int64_t _idleBytes;
+        // Capacities of buffers held by output streams.
+        unordered_map<byte*, int64_t> _acquiredBuffers;
+        deque<int64_t> _recentOutputSizes;
+        int64_t _allocationCount;
+        int64_t _reuseCount;
+
+        void AddIdleBuffer(byte* data, int64_t capacity);
+
+    public:
+        OutputBufferPool();
+        ~OutputBufferPool();
+
+        // Get the smallest idle buffer of at least minimumSize bytes, or allocate a new one with a quarter more room than recent outputs.
+        byte* Acquire(int64_t minimumSize, int64_t* capacity);
+
+        // Return a buffer held by an output stream to the pool, return false if the buffer was not acquired from this pool.
+        bool Release(byte* data);
+
+        // Hand a buffer held by an output stream to the caller as an output.
+        void DetachOutput(byte* data);
+
+        // Return an output of this pool to its idle buffers, outputs of other or destroyed pools are freed. Return false if data is not a pooled output.
+        bool ReleaseOutput(byte* data);
+
+        // Free an output without a pool, e.g. from TryReleaseUnmanagedData. Byte arrays that are not pooled outputs are freed as well.
+        static void FreeOutput(byte* data);
+
+        // Record the final size of an output, new buffers are sized to fit recent outputs without growing.
+        void RecordOutputSize(int64_t outputSize);
+
+        // Expected size of the next output, the largest recent output. Any idle buffer of this size can take the next output.
+        int64_t ExpectedOutputSize();
+
+        int64_t AllocationCount();
+        int64_t ReuseCount();
+};
+
+// Output stream writing directly into a pooled buffer, the buffer is handed to the caller with Detach instead of being copied.
+class PooledOutputStream : public arrow::io::OutputStream
+{
+    private:
+        OutputBufferPool* _pool;
+        byte* _data;
+        int64_t _capacity;
+        int64_t _position;
+        bool _closed;
+
+        arrow::Status Reserve(int64_t size);
+
+    public:
+        PooledOutputStream(OutputBufferPool* pool);
+        ~PooledOutputStream() override;
+
+        using arrow::io::OutputStream::Write;
+        arrow::Status Write(const void* data, int64_t nbytes) override;
+        arrow::Status Close() override;
+        arrow::Result<int64_t> Tell() const override;
+        bool closed() const override;
+
+        // Hand the written bytes to the caller, who returns them with ReleaseOutput or frees them with FreeOutput once consumed.
+        void Detach(byte** outputData, int* outputSize);
+};
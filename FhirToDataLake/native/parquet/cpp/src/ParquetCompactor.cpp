@@ -0,0 +1,163 @@
+#include "ParquetCompactor.h"
+#include "ParquetWriter.h"
+
+ParquetCompactor::ParquetCompactor(const shared_ptr<arrow::Schema>& schema, const ReaderPropertiesFactory& getReaderProperties, const WriterPropertiesFactory& getWriteProperties, const shared_ptr<parquet::ArrowWriterProperties>& arrowWriteProperties, const OutputStreamFactory& openOutput, int64_t targetFileSize)
+{
+    _schema = schema;
+    _getReaderProperties = getReaderProperties;
+    _getWriteProperties = getWriteProperties;
+    _arrowWriteProperties = arrowWriteProperties;
+    _openOutput = openOutput;
+    _targetFileSize = targetFileSize > 0 ? targetFileSize : ParquetOptions::CompactionFileSize;
+    _targetRowGroupSize = min(_targetFileSize, ParquetOptions::CompactionRowGroupSize);
+    _outputCount = 0;
+    _pendingBytes = 0;
+    _pendingCompressedBytes = 0;
+}
+
+// Write all buffered tables as one row group, and roll over to a new output once the current one reaches the target size.
+// A buffered row group reaches the output stream only when the next one starts or the writer closes, so the size of the output
+// is the stream position plus the compressed size of the row group just written, estimated from the input row groups.
+arrow::Status ParquetCompactor::FlushRowGroup()
+{
+    if (_pendingTables.empty())
+    {
+        return arrow::Status::OK();
+    }
+
+    if (_fileWriter == nullptr)
+    {
+        ARROW_ASSIGN_OR_RAISE(_outputStream, _openOutput(_outputCount));
+        _outputCount++;
+        ARROW_RETURN_NOT_OK(parquet::arrow::FileWriter::Open(*_schema, arrow::default_memory_pool(), _outputStream, _getWriteProperties(), _arrowWriteProperties, &_fileWriter));
+    }
+
+    ARROW_ASSIGN_OR_RAISE(const shared_ptr<arrow::Table> table, arrow::ConcatenateTables(_pendingTables));
+    const int64_t rowGroupSize = _pendingCompressedBytes;
+    _pendingTables.clear();
+    _pendingBytes = 0;
+    _pendingCompressedBytes = 0;
+    ARROW_RETURN_NOT_OK(WriteRowGroup(_fileWriter.get(), *table));
+
+    ARROW_ASSIGN_OR_RAISE(const int64_t outputSize, _outputStream->Tell());
+    if (outputSize + rowGroupSize >= _targetFileSize)
+    {
+        return CloseOutput();
+    }
+
+    return arrow::Status::OK();
+}
+
+arrow::Status ParquetCompactor::CloseOutput()
+{
+    if (_fileWriter == nullptr)
+    {
+        return arrow::Status::OK();
+    }
+
+    ARROW_RETURN_NOT_OK(_fileWriter->Close());
+    _fileWriter.reset();
+    // Parquet file writer closes its sink, this is a no-op unless the sink is shared with another writer.
+    if (!_outputStream->closed())
+    {
+        ARROW_RETURN_NOT_OK(_outputStream->Close());
+    }
+
+    _outputStream.reset();
+    return arrow::Status::OK();
+}
+
+int ParquetCompactor::Compact(const InputFileFactory& openInput, int inputCount, int* outputCount, char* errorMessage)
+{
+    *outputCount = 0;
+    if (inputCount <= 0)
+    {
+        WriteErrorMessage("No parquet input to compact.", errorMessage);
+        return ReadInputParquetError;
+    }
+
+    parquet::ArrowReaderProperties readProperties;
+    // Decode columns of a row group in parallel.
+    readProperties.set_use_threads(ParquetOptions::UseThreads);
+
+    for (int inputIndex = 0; inputIndex < inputCount; inputIndex++)
+    {
+        arrow::Result<shared_ptr<arrow::io::RandomAccessFile>> inputResult = openInput(inputIndex);
+        if (!inputResult.ok())
+        {
+            WriteErrorMessage(inputResult.status().ToString(), errorMessage);
+            return ReadInputParquetError;
+        }
+
+        parquet::arrow::FileReaderBuilder readerBuilder;
+        unique_ptr<parquet::arrow::FileReader> reader;
+        auto status = readerBuilder.Open(inputResult.ValueOrDie(), _getReaderProperties());
+        if (status.ok())
+        {
+            status = readerBuilder.properties(readProperties)->Build(&reader);
+        }
+
+        shared_ptr<arrow::Schema> inputSchema;
+        if (status.ok())
+        {
+            status = reader->GetSchema(&inputSchema);
+        }
+
+        if (!status.ok())
+        {
+            WriteErrorMessage(status.ToString(), errorMessage);
+            return ReadInputParquetError;
+        }
+
+        if (!inputSchema->Equals(*_schema, false))
+        {
+            WriteErrorMessage("Schema of parquet input " + to_string(inputIndex) + " does not match the target schema.", errorMessage);
+            return ReadInputParquetError;
+        }
+
+        const shared_ptr<parquet::FileMetaData> metadata = reader->parquet_reader()->metadata();
+        for (int rowGroupIndex = 0; rowGroupIndex < reader->num_row_groups(); rowGroupIndex++)
+        {
+            shared_ptr<arrow::Table> table;
+            status = reader->ReadRowGroup(rowGroupIndex, &table);
+            if (!status.ok())
+            {
+                WriteErrorMessage(status.ToString(), errorMessage);
+                return ReadInputParquetError;
+            }
+
+            _pendingTables.push_back(table);
+            const unique_ptr<parquet::RowGroupMetaData> rowGroupMetadata = metadata->RowGroup(rowGroupIndex);
+            _pendingBytes += rowGroupMetadata->total_byte_size();
+            for (int columnIndex = 0; columnIndex < rowGroupMetadata->num_columns(); columnIndex++)
+            {
+                _pendingCompressedBytes += rowGroupMetadata->ColumnChunk(columnIndex)->total_compressed_size();
+            }
+
+            if (_pendingBytes >= _targetRowGroupSize)
+            {
+                status = FlushRowGroup();
+                if (!status.ok())
+                {
+                    WriteErrorMessage(status.ToString(), errorMessage);
+                    return WriteToParquetError;
+                }
+            }
+        }
+    }
+
+    auto status = FlushRowGroup();
+    if (status.ok())
+    {
+        status = CloseOutput();
+    }
+
+    *outputCount = _outputCount;
+    if (!status.ok())
+    {
+        WriteErrorMessage(status.ToString(), errorMessage);
+        return WriteToParquetError;
+    }
+
+    return 0;
+}
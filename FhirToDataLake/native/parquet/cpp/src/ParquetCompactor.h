@@ -0,0 +1,49 @@
+#pragma once
+#include <arrow/api.h>
+#include <arrow/io/api.h>
+#include <parquet/arrow/reader.h>
+#include <parquet/arrow/writer.h>
+#include <functional>
+#include <vector>
+#include "ParquetOptions.h"
+#include "ErrorCodes.h"
+
+using namespace std;
+
+typedef function<arrow::Result<shared_ptr<arrow::io::RandomAccessFile>>(int inputIndex)> InputFileFactory;
+typedef function<arrow::Result<shared_ptr<arrow::io::OutputStream>>(int outputIndex)> OutputStreamFactory;
+// Properties are created per file, encryption properties of arrow can't be shared between files.
+typedef function<parquet::ReaderProperties()> ReaderPropertiesFactory;
+typedef function<shared_ptr<parquet::WriterProperties>()> WriterPropertiesFactory;
+
+// Merge parquet inputs of the same schema into size-targeted outputs.
+// Inputs are opened one at a time and read one row group at a time, small row groups are buffered
+// until about targetRowGroupSize uncompressed bytes and then written as a single row group.
+class ParquetCompactor
+{
+    private:
+        shared_ptr<arrow::Schema> _schema;
+        ReaderPropertiesFactory _getReaderProperties;
+        WriterPropertiesFactory _getWriteProperties;
+        shared_ptr<parquet::ArrowWriterProperties> _arrowWriteProperties;
+        int64_t _targetFileSize;
+        int64_t _targetRowGroupSize;
+
+        OutputStreamFactory _openOutput;
+        shared_ptr<arrow::io::OutputStream> _outputStream;
+        unique_ptr<parquet::arrow::FileWriter> _fileWriter;
+        int _outputCount;
+
+        vector<shared_ptr<arrow::Table>> _pendingTables;
+        int64_t _pendingBytes;
+        int64_t _pendingCompressedBytes;
+
+        arrow::Status FlushRowGroup();
+        arrow::Status CloseOutput();
+
+    public:
+        ParquetCompactor(const shared_ptr<arrow::Schema>& schema, const ReaderPropertiesFactory& getReaderProperties, const WriterPropertiesFactory& getWriteProperties, const shared_ptr<parquet::ArrowWriterProperties>& arrowWriteProperties, const OutputStreamFactory& openOutput, int64_t targetFileSize);
+
+        // Compact all inputs, outputCount is set to the number of outputs opened from openOutput.
+        int Compact(const InputFileFactory& openInput, int inputCount, int* outputCount, char* errorMessage);
+};
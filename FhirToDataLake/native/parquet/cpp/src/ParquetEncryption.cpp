@@ -0,0 +1,189 @@
+#include "ParquetEncryption.h"
+#include "TableFlattener.h"
+
+// Parquet column paths of the leaves of field, paired with the field path without the list levels that users name in prefixes.
+static void CollectLeafColumns(const shared_ptr<arrow::Field>& field, const string& columnPrefix, const string& fieldPrefix, vector<pair<string, string>>* leaves)
+{
+    string columnPath = columnPrefix + field->name();
+    shared_ptr<arrow::DataType> type = field->type();
+    while (type->id() == arrow::Type::LIST)
+    {
+        // Arrow writes a list as a group with a repeated "list" group around the element.
+        const auto& valueField = static_cast<const arrow::ListType&>(*type).value_field();
+        columnPath += ".list." + valueField->name();
+        type = valueField->type();
+    }
+
+    const string fieldPath = fieldPrefix + field->name();
+    if (type->id() != arrow::Type::STRUCT)
+    {
+        leaves->push_back(make_pair(columnPath, fieldPath));
+        return;
+    }
+
+    for (const auto& subField : type->fields())
+    {
+        CollectLeafColumns(subField, columnPath + ".", fieldPath + ".", leaves);
+    }
+}
+
+static vector<pair<string, string>> GetLeafColumns(const arrow::Schema& schema)
+{
+    vector<pair<string, string>> leaves;
+    for (const auto& field : schema.fields())
+    {
+        CollectLeafColumns(field, "", "", &leaves);
+    }
+
+    return leaves;
+}
+
+static bool IsPathPrefix(const string& prefix, const string& path)
+{
+    return path == prefix || path.compare(0, prefix.size() + 1, prefix + ".") == 0;
+}
+
+// Prefix relative to the fields of a child table, an empty prefix covers all its promoted columns.
+// Return false if the prefix is outside the promoted path.
+static bool GetRelativePrefix(const string& prefix, const string& flattenedPath, string* relativePrefix)
+{
+    if (flattenedPath.empty())
+    {
+        *relativePrefix = prefix;
+        return true;
+    }
+
+    if (IsPathPrefix(prefix, flattenedPath))
+    {
+        relativePrefix->clear();
+        return true;
+    }
+
+    if (IsPathPrefix(flattenedPath, prefix))
+    {
+        *relativePrefix = prefix.substr(flattenedPath.size() + 1);
+        return true;
+    }
+
+    return false;
+}
+
+// Parquet column paths of schema with their key, an empty key stands for the footer key.
+// The resourceId and ordinal columns of a child table keep the footer key.
+static vector<pair<string, string>> GetColumnKeys(const arrow::Schema& schema, const EncryptionKeys& keys, const string& flattenedPath)
+{
+    vector<pair<string, string>> columnKeys;
+    for (const auto& leaf : GetLeafColumns(schema))
+    {
+        string key;
+        const bool isKeyColumn = !flattenedPath.empty() && IsChildKeyColumn(flattenedPath, leaf.second);
+        for (const auto& columnKey : keys.columnKeys)
+        {
+            string relativePrefix;
+            if (!isKeyColumn && GetRelativePrefix(columnKey.first, flattenedPath, &relativePrefix) && (relativePrefix.empty() || IsPathPrefix(relativePrefix, leaf.second)))
+            {
+                key = columnKey.second;
+            }
+        }
+
+        columnKeys.push_back(make_pair(leaf.first, key));
+    }
+
+    return columnKeys;
+}
+
+static bool IsValidKeyLength(const string& key)
+{
+    return key.size() == 16 || key.size() == 24 || key.size() == 32;
+}
+
+bool ValidateEncryptionKeys(const arrow::Schema& schema, const EncryptionKeys& keys, string* error)
+{
+    if (!IsValidKeyLength(keys.footerKey))
+    {
+        *error = "Footer key must be 16, 24 or 32 bytes.";
+        return false;
+    }
+
+    const auto leaves = GetLeafColumns(schema);
+    for (const auto& columnKey : keys.columnKeys)
+    {
+        const string& prefix = columnKey.first;
+        if (!IsValidKeyLength(columnKey.second))
+        {
+            *error = "Key of column prefix '" + prefix + "' must be 16, 24 or 32 bytes.";
+            return false;
+        }
+
+        bool found = false;
+        for (const auto& leaf : leaves)
+        {
+            found = found || (!prefix.empty() && IsPathPrefix(prefix, leaf.second));
+        }
+
+        if (!found)
+        {
+            *error = "Column prefix '" + prefix + "' not found in schema.";
+            return false;
+        }
+
+        for (const auto& other : keys.columnKeys)
+        {
+            if (&other != &columnKey && IsPathPrefix(other.first, prefix))
+            {
+                *error = "Column prefix '" + prefix + "' overlaps with '" + other.first + "'.";
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+shared_ptr<parquet::FileEncryptionProperties> BuildEncryptionProperties(const arrow::Schema& schema, const EncryptionKeys& keys, const string& flattenedPath)
+{
+    // Once any column has its own key, arrow leaves the columns missing from the map in plaintext. So every column is listed,
+    // and columns without a key of their own are encrypted with the footer key.
+    parquet::ColumnPathToEncryptionPropertiesMap encryptedColumns;
+    bool hasColumnKey = false;
+    for (const auto& columnKey : GetColumnKeys(schema, keys, flattenedPath))
+    {
+        parquet::ColumnEncryptionProperties::Builder columnBuilder(columnKey.first);
+        if (!columnKey.second.empty())
+        {
+            columnBuilder.key(columnKey.second);
+            hasColumnKey = true;
+        }
+
+        encryptedColumns[columnKey.first] = columnBuilder.build();
+    }
+
+    parquet::FileEncryptionProperties::Builder builder(keys.footerKey);
+    if (hasColumnKey)
+    {
+        builder.encrypted_columns(encryptedColumns);
+    }
+
+    return builder.build();
+}
+
+shared_ptr<parquet::FileDecryptionProperties> BuildDecryptionProperties(const arrow::Schema& schema, const EncryptionKeys& keys, const string& flattenedPath)
+{
+    parquet::ColumnPathToDecryptionPropertiesMap decryptedColumns;
+    for (const auto& columnKey : GetColumnKeys(schema, keys, flattenedPath))
+    {
+        if (!columnKey.second.empty())
+        {
+            decryptedColumns[columnKey.first] = parquet::ColumnDecryptionProperties::Builder(columnKey.first).key(columnKey.second)->build();
+        }
+    }
+
+    parquet::FileDecryptionProperties::Builder builder;
+    builder.footer_key(keys.footerKey);
+    if (!decryptedColumns.empty())
+    {
+        builder.column_keys(decryptedColumns);
+    }
+
+    return builder.build();
+}
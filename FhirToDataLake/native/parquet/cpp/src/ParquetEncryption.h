@@ -0,0 +1,26 @@
+#pragma once
+#include <arrow/api.h>
+#include <parquet/properties.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+// Raw AES keys of parquet modular encryption for the outputs of a schema, each key is 16, 24 or 32 bytes.
+struct EncryptionKeys
+{
+    string footerKey;
+    // Field prefixes like "name" or "identifier.value" and their keys, columns without a key of their own are encrypted with the footer key.
+    vector<pair<string, string>> columnKeys;
+};
+
+// Check key lengths and that every column prefix names fields of schema without overlapping another prefix. Return false with error set otherwise.
+bool ValidateEncryptionKeys(const arrow::Schema& schema, const EncryptionKeys& keys, string* error);
+
+// Encryption properties for one output of schema, flattenedPath is the promoted path of a child table and empty for the resource table.
+// Arrow does not allow encryption properties to be reused across files, so they are built for every output.
+shared_ptr<parquet::FileEncryptionProperties> BuildEncryptionProperties(const arrow::Schema& schema, const EncryptionKeys& keys, const string& flattenedPath);
+
+// Decryption properties for reading one output written with BuildEncryptionProperties.
+shared_ptr<parquet::FileDecryptionProperties> BuildDecryptionProperties(const arrow::Schema& schema, const EncryptionKeys& keys, const string& flattenedPath);
@@ -40,12 +40,362 @@ int ConvertJsonToParquet(ParquetWriter* writer, const char* schemaKey, const cha
     return writer->Write(key, inputJson, inputLength, outputData, outputLength, errorMessage);
 }
 
-// Try to release the allocated parquet stream.
+// Queue input json data conversion on the writer's executor, so the caller thread is not blocked during parse and encode.
+int ConvertJsonToParquetAsync(ParquetWriter* writer, const char* schemaKey, const char* inputJson, int inputLength, ConversionCallback callback, void* state, long long* jobId, char* errorMessage)
+{
+    if (schemaKey == nullptr)
+    {
+        return ParseParquetSchemaError;
+    }
+
+    string key = schemaKey;
+    return writer->WriteAsync(key, inputJson, inputLength, callback, state, jobId, errorMessage);
+}
+
+int CancelConversion(ParquetWriter* writer, long long jobId)
+{
+    return writer->CancelAsync(jobId);
+}
+
+int SetMaxInFlightConversions(ParquetWriter* writer, int maxInFlightConversions)
+{
+    return writer->SetMaxInFlightJobs(maxInFlightConversions);
+}
+
+int SetFlattenedPaths(ParquetWriter* writer, const char* schemaKey, const char** paths, int pathCount, char* errorMessage)
+{
+    if (schemaKey == nullptr)
+    {
+        return ParseParquetSchemaError;
+    }
+
+    if (paths == nullptr && pathCount > 0)
+    {
+        WriteErrorMessage("Flattened paths are null.", errorMessage);
+        return ParseParquetSchemaError;
+    }
+
+    vector<string> flattenedPaths;
+    for (int i = 0; i < pathCount; i++)
+    {
+        if (paths[i] == nullptr)
+        {
+            WriteErrorMessage("Flattened path " + to_string(i) + " is null.", errorMessage);
+            return ParseParquetSchemaError;
+        }
+
+        flattenedPaths.push_back(paths[i]);
+    }
+
+    string key = schemaKey;
+    return writer->SetFlattenedPaths(key, flattenedPaths, errorMessage);
+}
+
+int SetEncryptionKeys(ParquetWriter* writer, const char* schemaKey, const byte* footerKey, int footerKeyLength, const char** columnPrefixes, const byte** columnKeys, const int* columnKeyLengths, int columnCount, char* errorMessage)
+{
+    if (schemaKey == nullptr)
+    {
+        return ParseParquetSchemaError;
+    }
+
+    if (columnCount > 0 && (columnPrefixes == nullptr || columnKeys == nullptr || columnKeyLengths == nullptr))
+    {
+        WriteErrorMessage("Column prefixes or keys are null.", errorMessage);
+        return InvalidEncryptionKeys;
+    }
+
+    EncryptionKeys keys;
+    if (footerKey != nullptr && footerKeyLength > 0)
+    {
+        keys.footerKey.assign(reinterpret_cast<const char*>(footerKey), footerKeyLength);
+    }
+
+    for (int i = 0; i < columnCount; i++)
+    {
+        if (columnPrefixes[i] == nullptr || columnKeys[i] == nullptr || columnKeyLengths[i] <= 0)
+        {
+            WriteErrorMessage("Column prefix or key " + to_string(i) + " is null.", errorMessage);
+            return InvalidEncryptionKeys;
+        }
+
+        keys.columnKeys.push_back(make_pair(string(columnPrefixes[i]), string(reinterpret_cast<const char*>(columnKeys[i]), columnKeyLengths[i])));
+    }
+
+    string key = schemaKey;
+    return writer->SetEncryptionKeys(key, keys, errorMessage);
+}
+
+int SetPageChecksum(ParquetWriter* writer, int enabled, char* errorMessage)
+{
+    return writer->SetPageChecksum(enabled != 0, errorMessage);
+}
+
+// Convert input json of any input format to an output set, so a Bundle or a mixed export is converted in one call without splitting it on the managed side.
+int ConvertJsonToParquetOutputs(ParquetWriter* writer, const char* schemaKey, int inputFormat, const char* inputJson, int inputLength, ParquetOutputSet** outputs, char* errorMessage)
+{
+    if (schemaKey == nullptr && inputFormat != Bundle && inputFormat != MixedNdjson)
+    {
+        return ParseParquetSchemaError;
+    }
+
+    if (outputs == nullptr)
+    {
+        WriteErrorMessage("Output set pointer is null.", errorMessage);
+        return WriteToParquetError;
+    }
+
+    string key = schemaKey == nullptr ? "" : schemaKey;
+    ParquetOutputSet* outputSet = new ParquetOutputSet();
+    int status = writer->Write(key, static_cast<InputFormat>(inputFormat), inputJson, inputLength, outputSet, errorMessage);
+    if (status != 0)
+    {
+        delete outputSet;
+        return status;
+    }
+
+    *outputs = outputSet;
+    return 0;
+}
+
+// Convert input json data to arrow IPC file bytes, the output byte array is allocated the same way as ConvertJsonToParquet.
+int ConvertJsonToArrowIpc(ParquetWriter* writer, const char* schemaKey, const char* inputJson, int inputLength, byte** outputData, int *outputLength, char* errorMessage)
+{
+    if (schemaKey == nullptr)
+    {
+        return ParseParquetSchemaError;
+    }
+
+    string key = schemaKey;
+    return writer->WriteArrowIpc(key, inputJson, inputLength, outputData, outputLength, errorMessage);
+}
+
+// Convert input json data to arrow C stream, so in-process consumers can use the columnar data without decoding parquet again.
+int ConvertJsonToArrowStream(ParquetWriter* writer, const char* schemaKey, const char* inputJson, int inputLength, struct ArrowArrayStream* outputStream, char* errorMessage)
+{
+    if (schemaKey == nullptr)
+    {
+        return ParseParquetSchemaError;
+    }
+
+    string key = schemaKey;
+    return writer->WriteArrowStream(key, inputJson, inputLength, outputStream, errorMessage);
+}
+
+// Compact in-memory parquet buffers, the input buffers are wrapped without copy and outputs stay in native memory until the output set is destroyed.
+int CompactParquetBuffers(ParquetWriter* writer, const char* schemaKey, const byte** inputData, const int* inputLengths, int inputCount, long long targetFileSize, ParquetOutputSet** outputs, char* errorMessage)
+{
+    if (schemaKey == nullptr)
+    {
+        return ParseParquetSchemaError;
+    }
+
+    if (inputData == nullptr || inputLengths == nullptr)
+    {
+        WriteErrorMessage("Input parquet data is null.", errorMessage);
+        return ReadInputParquetError;
+    }
+
+    if (outputs == nullptr)
+    {
+        WriteErrorMessage("Output set pointer is null.", errorMessage);
+        return WriteToParquetError;
+    }
+
+    InputFileFactory openInput = [&](int inputIndex) -> arrow::Result<shared_ptr<arrow::io::RandomAccessFile>>
+    {
+        if (inputData[inputIndex] == nullptr)
+        {
+            return arrow::Status::Invalid("Input parquet data ", inputIndex, " is null.");
+        }
+
+        const auto buffer = make_shared<arrow::Buffer>(inputData[inputIndex], static_cast<int64_t>(inputLengths[inputIndex]));
+        return make_shared<arrow::io::BufferReader>(buffer);
+    };
+
+    vector<shared_ptr<arrow::io::BufferOutputStream>> outputStreams;
+    OutputStreamFactory openOutput = [&](int outputIndex) -> arrow::Result<shared_ptr<arrow::io::OutputStream>>
+    {
+        ARROW_ASSIGN_OR_RAISE(auto outputStream, arrow::io::BufferOutputStream::Create());
+        outputStreams.push_back(outputStream);
+        return outputStream;
+    };
+
+    string key = schemaKey;
+    int outputCount = 0;
+    int status = writer->Compact(key, openInput, inputCount, openOutput, targetFileSize, &outputCount, errorMessage);
+    if (status != 0)
+    {
+        return status;
+    }
+
+    ParquetOutputSet* outputSet = new ParquetOutputSet();
+    for (const auto& outputStream : outputStreams)
+    {
+        outputSet->Add(key, outputStream->Finish().ValueOrDie());
+    }
+
+    *outputs = outputSet;
+    return 0;
+}
+
+// Compact parquet files on disk, inputs are opened one at a time so the number of inputs is not limited by open file handles.
+int CompactParquetFiles(ParquetWriter* writer, const char* schemaKey, const char** inputPaths, int inputCount, const char* outputPathPrefix, long long targetFileSize, int* outputCount, char* errorMessage)
+{
+    if (schemaKey == nullptr)
+    {
+        return ParseParquetSchemaError;
+    }
+
+    if (inputPaths == nullptr)
+    {
+        WriteErrorMessage("Input parquet paths are null.", errorMessage);
+        return ReadInputParquetError;
+    }
+
+    if (outputPathPrefix == nullptr)
+    {
+        WriteErrorMessage("Output path prefix is null.", errorMessage);
+        return WriteToParquetError;
+    }
+
+    InputFileFactory openInput = [&](int inputIndex) -> arrow::Result<shared_ptr<arrow::io::RandomAccessFile>>
+    {
+        if (inputPaths[inputIndex] == nullptr)
+        {
+            return arrow::Status::Invalid("Input parquet path ", inputIndex, " is null.");
+        }
+
+        ARROW_ASSIGN_OR_RAISE(auto inputFile, arrow::io::ReadableFile::Open(inputPaths[inputIndex]));
+        return inputFile;
+    };
+
+    string pathPrefix = outputPathPrefix;
+    OutputStreamFactory openOutput = [&](int outputIndex) -> arrow::Result<shared_ptr<arrow::io::OutputStream>>
+    {
+        ARROW_ASSIGN_OR_RAISE(auto outputFile, arrow::io::FileOutputStream::Open(pathPrefix + to_string(outputIndex) + ".parquet"));
+        return outputFile;
+    };
+
+    string key = schemaKey;
+    return writer->Compact(key, openInput, inputCount, openOutput, targetFileSize, outputCount, errorMessage);
+}
+
+int GetParquetOutputCount(ParquetOutputSet* outputs)
+{
+    if (outputs == nullptr)
+    {
+        return 0;
+    }
+
+    return outputs->Count();
+}
+
+int GetParquetOutput(ParquetOutputSet* outputs, int index, const char** outputKey, const byte** outputData, int* outputLength)
+{
+    if (outputs == nullptr || outputKey == nullptr || outputData == nullptr || outputLength == nullptr)
+    {
+        return WriteToParquetError;
+    }
+
+    const string* key;
+    shared_ptr<arrow::Buffer> buffer;
+    if (!outputs->Get(index, &key, &buffer))
+    {
+        return WriteToParquetError;
+    }
+
+    *outputKey = key->c_str();
+    *outputData = reinterpret_cast<const byte*>(buffer->data());
+    *outputLength = static_cast<int>(buffer->size());
+    return 0;
+}
+
+int GetSkippedResourceTypeCount(ParquetOutputSet* outputs)
+{
+    if (outputs == nullptr)
+    {
+        return 0;
+    }
+
+    return outputs->SkippedCount();
+}
+
+int GetSkippedResourceType(ParquetOutputSet* outputs, int index, const char** resourceType)
+{
+    if (outputs == nullptr || resourceType == nullptr)
+    {
+        return WriteToParquetError;
+    }
+
+    const string* key;
+    if (!outputs->GetSkipped(index, &key))
+    {
+        return WriteToParquetError;
+    }
+
+    *resourceType = key->c_str();
+    return 0;
+}
+
+void DestroyParquetOutputSet(ParquetOutputSet* outputs)
+{
+    if (outputs != nullptr)
+    {
+        delete outputs;
+    }
+}
+
+// Release parquet bytes through the writer, so the byte array is kept for the next conversion instead of being freed.
+int ReleaseParquetOutput(ParquetWriter* writer, byte** data)
+{
+    if (data != nullptr && *data != nullptr)
+    {
+        writer->ReleaseOutput(*data);
+        *data = nullptr;
+    }
+
+    return 0;
+}
+
+// Statistics are kept per schema key from the successful parquet conversions of this writer.
+int GetConversionStatistics(ParquetWriter* writer, const char* schemaKey, ConversionStatistics* statistics)
+{
+    if (schemaKey == nullptr)
+    {
+        return ParseParquetSchemaError;
+    }
+
+    if (statistics == nullptr)
+    {
+        return WriteToParquetError;
+    }
+
+    string key = schemaKey;
+    return writer->GetStatistics(key, statistics);
+}
+
+int GetRecommendedBatchSize(ParquetWriter* writer, const char* schemaKey, long long targetOutputBytes, int targetLatencyMilliseconds, long long* recommendedInputBytes, long long* recommendedRows)
+{
+    if (schemaKey == nullptr)
+    {
+        return ParseParquetSchemaError;
+    }
+
+    if (recommendedInputBytes == nullptr || recommendedRows == nullptr)
+    {
+        return WriteToParquetError;
+    }
+
+    string key = schemaKey;
+    return writer->GetRecommendedBatchSize(key, targetOutputBytes, targetLatencyMilliseconds, recommendedInputBytes, recommendedRows);
+}
+
+// Try to release the allocated parquet stream, a pooled output is also removed from the pool it came from.
 int TryReleaseUnmanagedData(byte** data)
 {
     if (data != nullptr && *data != nullptr)
     {
-        delete *data;
+        OutputBufferPool::FreeOutput(*data);
         *data = nullptr;
     }
 
@@ -15,6 +15,7 @@
 #include <iostream>
 #include <string>
 #include "ParquetWriter.h"
+#include "ParquetOutputSet.h"
 
 using namespace std;
 
@@ -27,5 +28,50 @@ extern "C" EXPORT void DestroyParquetWriter(ParquetWriter* writer);
 extern "C" EXPORT int RegisterParquetSchema(ParquetWriter* writer, const char* schemaKey, const char* schemaData);
 // Convert input json to parquet bytes.
 extern "C" EXPORT int ConvertJsonToParquet(ParquetWriter* writer, const char* schemaKey, const char* inputJson, int inputLength, byte** outputData, int* outputLength, char* errorMessage);
+// Queue conversion of input json to parquet bytes, callback receives the output which is released with ReleaseParquetOutput.
+// inputJson must stay valid until the callback is invoked, and the callback must not destroy the writer.
+extern "C" EXPORT int ConvertJsonToParquetAsync(ParquetWriter* writer, const char* schemaKey, const char* inputJson, int inputLength, ConversionCallback callback, void* state, long long* jobId, char* errorMessage);
+// Cancel a queued or running async conversion.
+extern "C" EXPORT int CancelConversion(ParquetWriter* writer, long long jobId);
+// Set the maximum number of async conversions in flight for the writer.
+extern "C" EXPORT int SetMaxInFlightConversions(ParquetWriter* writer, int maxInFlightConversions);
+// Promote repeated paths like "component.code.coding" of schemaKey to child tables keyed by resource id and list ordinals, the child tables are
+// returned as extra outputs named schemaKey_component_code_coding by ConvertJsonToParquetOutputs. A pathCount of 0 clears the paths.
+extern "C" EXPORT int SetFlattenedPaths(ParquetWriter* writer, const char* schemaKey, const char** paths, int pathCount, char* errorMessage);
+// Encrypt parquet outputs of schemaKey with parquet modular encryption while they are written. Keys are raw AES keys of 16, 24 or 32 bytes,
+// columns under a prefix like "name" or "identifier" use the key of the prefix and all other columns and the footer use footerKey.
+// A null footerKey with a columnCount of 0 disables encryption.
+extern "C" EXPORT int SetEncryptionKeys(ParquetWriter* writer, const char* schemaKey, const byte* footerKey, int footerKeyLength, const char** columnPrefixes, const byte** columnKeys, const int* columnKeyLengths, int columnCount, char* errorMessage);
+// Write CRC checksums of data pages in all parquet outputs, returns PageChecksumNotSupported if the arrow version can't write them.
+extern "C" EXPORT int SetPageChecksum(ParquetWriter* writer, int enabled, char* errorMessage);
+// Convert input json in inputFormat (0 ndjson, 1 json array, 2 FHIR Bundle, 3 mixed ndjson) to parquet outputs keyed by schema key, release the outputs with DestroyParquetOutputSet.
+// schemaKey may be null for Bundle and mixed ndjson input, each resource is converted with the schema registered for its resourceType.
+// Resource types without a registered schema are skipped, see GetSkippedResourceType.
+extern "C" EXPORT int ConvertJsonToParquetOutputs(ParquetWriter* writer, const char* schemaKey, int inputFormat, const char* inputJson, int inputLength, ParquetOutputSet** outputs, char* errorMessage);
+// Convert input json to arrow IPC file (feather v2) bytes, release the output with TryReleaseUnmanagedData.
+extern "C" EXPORT int ConvertJsonToArrowIpc(ParquetWriter* writer, const char* schemaKey, const char* inputJson, int inputLength, byte** outputData, int* outputLength, char* errorMessage);
+// Convert input json to an arrow C stream, the consumer releases the stream with its own release callback.
+extern "C" EXPORT int ConvertJsonToArrowStream(ParquetWriter* writer, const char* schemaKey, const char* inputJson, int inputLength, struct ArrowArrayStream* outputStream, char* errorMessage);
+// Compact parquet buffers of the same schema into outputs of about targetFileSize bytes, release the outputs with DestroyParquetOutputSet.
+extern "C" EXPORT int CompactParquetBuffers(ParquetWriter* writer, const char* schemaKey, const byte** inputData, const int* inputLengths, int inputCount, long long targetFileSize, ParquetOutputSet** outputs, char* errorMessage);
+// Compact parquet files of the same schema into files named outputPathPrefix{index}.parquet.
+extern "C" EXPORT int CompactParquetFiles(ParquetWriter* writer, const char* schemaKey, const char** inputPaths, int inputCount, const char* outputPathPrefix, long long targetFileSize, int* outputCount, char* errorMessage);
+// Get the number of outputs in an output set.
+extern "C" EXPORT int GetParquetOutputCount(ParquetOutputSet* outputs);
+// Get key and bytes of the output at index, the data is owned by the output set.
+extern "C" EXPORT int GetParquetOutput(ParquetOutputSet* outputs, int index, const char** outputKey, const byte** outputData, int* outputLength);
+// Get the number of resource types of a Bundle or mixed ndjson input that were skipped because no schema is registered for them.
+extern "C" EXPORT int GetSkippedResourceTypeCount(ParquetOutputSet* outputs);
+// Get the skipped resource type at index, the string is owned by the output set.
+extern "C" EXPORT int GetSkippedResourceType(ParquetOutputSet* outputs, int index, const char** resourceType);
+// Destroy the output set and release memory of all its outputs.
+extern "C" EXPORT void DestroyParquetOutputSet(ParquetOutputSet* outputs);
+// Return parquet bytes from ConvertJsonToParquet or an async callback to the writer's buffer pool for reuse. TryReleaseUnmanagedData
+// frees them instead, which is needed once the writer is destroyed. These two are the only ways to free the bytes.
+extern "C" EXPORT int ReleaseParquetOutput(ParquetWriter* writer, byte** data);
+// Get moving averages of the conversions of schemaKey, return ConversionStatisticsNotFound before its first conversion.
+extern "C" EXPORT int GetConversionStatistics(ParquetWriter* writer, const char* schemaKey, ConversionStatistics* statistics);
+// Recommend an input batch size for schemaKey that produces about targetOutputBytes of parquet within targetLatencyMilliseconds, a non-positive latency is ignored.
+extern "C" EXPORT int GetRecommendedBatchSize(ParquetWriter* writer, const char* schemaKey, long long targetOutputBytes, int targetLatencyMilliseconds, long long* recommendedInputBytes, long long* recommendedRows);
 // Release memory of parquet bytes.
 extern "C" EXPORT int TryReleaseUnmanagedData(byte** data);
\ No newline at end of file
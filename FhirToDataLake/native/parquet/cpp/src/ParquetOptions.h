@@ -13,4 +13,37 @@ namespace ParquetOptions
     const int WriteBatchSize = 100;
 
     const arrow::Compression::type Compression = arrow::Compression::SNAPPY;
+
+    // Each write call produces a single row group, so the row count of a buffered row group is not capped.
+    const int64_t MaxRowGroupLength = INT64_MAX;
+
+    // Idle output buffers kept per writer, also the number of recent output sizes used to size new buffers.
+    const int OutputBufferPoolSize = 4;
+
+    // Bytes of idle output buffers kept per writer, the largest idle buffers are freed above it.
+    const int64_t OutputBufferPoolMaxIdleBytes = 1LL << 28;
+
+    // Capacity of the first output buffer before any output size is known.
+    const int64_t InitialOutputBufferSize = 1 << 20;
+
+    // Inputs larger than this are parsed in chunks of about this size, each parsed chunk is encoded as a row group while the next one is parsed.
+    const int PipelineChunkSize = 1 << 26;
+
+    // Parsed chunks buffered between the parser and the encoder.
+    const int PipelineQueueSize = 2;
+
+    // Weight of the latest conversion in the per schema key moving averages.
+    const double StatisticsSmoothingFactor = 0.2;
+
+    // Number of threads of the executor running async conversions and the resource types of output set conversions.
+    const int AsyncThreadCount = 4;
+
+    // Default limit of async conversions in flight per writer.
+    const int MaxInFlightJobs = 16;
+
+    // Default output size when compacting parquet files.
+    const int64_t CompactionFileSize = 1LL << 28;
+
+    // Uncompressed bytes buffered from small input row groups before they are written as one row group.
+    const int64_t CompactionRowGroupSize = 1LL << 27;
 };
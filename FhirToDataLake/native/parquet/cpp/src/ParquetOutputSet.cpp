@@ -0,0 +1,45 @@
+#include "ParquetOutputSet.h"
+
+void ParquetOutputSet::Add(const string& key, const shared_ptr<arrow::Buffer>& buffer)
+{
+    _keys.push_back(key);
+    _buffers.push_back(buffer);
+}
+
+int ParquetOutputSet::Count() const
+{
+    return static_cast<int>(_buffers.size());
+}
+
+bool ParquetOutputSet::Get(int index, const string** key, shared_ptr<arrow::Buffer>* buffer) const
+{
+    if (index < 0 || index >= Count())
+    {
+        return false;
+    }
+
+    *key = &_keys[index];
+    *buffer = _buffers[index];
+    return true;
+}
+
+void ParquetOutputSet::AddSkipped(const string& key)
+{
+    _skippedKeys.push_back(key);
+}
+
+int ParquetOutputSet::SkippedCount() const
+{
+    return static_cast<int>(_skippedKeys.size());
+}
+
+bool ParquetOutputSet::GetSkipped(int index, const string** key) const
+{
+    if (index < 0 || index >= SkippedCount())
+    {
+        return false;
+    }
+
+    *key = &_skippedKeys[index];
+    return true;
+}
@@ -0,0 +1,31 @@
+#pragma once
+#include <arrow/api.h>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Keyed output buffers of a single native call that produces more than one parquet output.
+class ParquetOutputSet
+{
+    private:
+        vector<string> _keys;
+        vector<shared_ptr<arrow::Buffer>> _buffers;
+        vector<string> _skippedKeys;
+
+    public:
+        void Add(const string& key, const shared_ptr<arrow::Buffer>& buffer);
+
+        int Count() const;
+
+        // Return false if index is out of range.
+        bool Get(int index, const string** key, shared_ptr<arrow::Buffer>* buffer) const;
+
+        // Keys of input resources that were not converted because no schema is registered for them.
+        void AddSkipped(const string& key);
+
+        int SkippedCount() const;
+
+        // Return false if index is out of range.
+        bool GetSkipped(int index, const string** key) const;
+};
@@ -1,14 +1,57 @@
 #include "ParquetWriter.h"
+#include <arrow/c/bridge.h>
 #include <arrow/io/api.h>
+#include <arrow/ipc/api.h>
+#include <arrow/util/config.h>
 #include <parquet/arrow/reader.h>
 #include <parquet/arrow/writer.h>
+#include <algorithm>
+#include <array>
+#include <chrono>
 #include <iostream>
 #include <fstream>
+#include <thread>
 
-int WriteToParquet(const shared_ptr<arrow::Table> table, byte** outputData, int* outputSize, char* errorMessage, const shared_ptr<parquet::WriterProperties> writeProperties)
+void CopyToOutput(const shared_ptr<arrow::Buffer>& buffer, byte** outputData, int* outputSize)
 {
-    const shared_ptr<arrow::io::BufferOutputStream> outputStream = parquet::CreateOutputStream();
-    const auto status = parquet::arrow::WriteTable(*table, arrow::default_memory_pool(), outputStream, table->num_rows(), writeProperties);
+    const byte* bytes = reinterpret_cast<const byte*>(buffer->data());
+    *outputSize = buffer->size();
+    *outputData = new byte[*outputSize];
+    memcpy(*outputData, bytes, *outputSize);
+}
+
+// Buffer the whole table as one row group, the buffered row group mode is where arrow writer properties with use_threads
+// encode and compress the column chunks in parallel.
+arrow::Status WriteRowGroup(parquet::arrow::FileWriter* fileWriter, const arrow::Table& table)
+{
+    ARROW_RETURN_NOT_OK(fileWriter->NewBufferedRowGroup());
+
+    arrow::TableBatchReader batchReader(table);
+    shared_ptr<arrow::RecordBatch> batch;
+    ARROW_RETURN_NOT_OK(batchReader.ReadNext(&batch));
+    while (batch != nullptr)
+    {
+        ARROW_RETURN_NOT_OK(fileWriter->WriteRecordBatch(*batch));
+        ARROW_RETURN_NOT_OK(batchReader.ReadNext(&batch));
+    }
+
+    return arrow::Status::OK();
+}
+
+int WriteToParquet(const shared_ptr<arrow::Table> table, const shared_ptr<arrow::io::OutputStream>& outputStream, char* errorMessage, const shared_ptr<parquet::WriterProperties> writeProperties, const shared_ptr<parquet::ArrowWriterProperties> arrowWriteProperties)
+{
+    unique_ptr<parquet::arrow::FileWriter> fileWriter;
+    auto status = parquet::arrow::FileWriter::Open(*table->schema(), arrow::default_memory_pool(), outputStream, writeProperties, arrowWriteProperties, &fileWriter);
+    if (status.ok())
+    {
+        status = WriteRowGroup(fileWriter.get(), *table);
+    }
+
+    if (status.ok())
+    {
+        status = fileWriter->Close();
+    }
+
     if (!status.ok())
     {
         string errorDetail = status.ToString();
@@ -16,70 +59,313 @@ int WriteToParquet(const shared_ptr<arrow::Table> table, byte** outputData, int*
         return WriteToParquetError;
     }
 
+    return 0;
+}
+
+int WriteToParquet(const shared_ptr<arrow::Table> table, byte** outputData, int* outputSize, char* errorMessage, const shared_ptr<parquet::WriterProperties> writeProperties, const shared_ptr<parquet::ArrowWriterProperties> arrowWriteProperties, OutputBufferPool* outputBufferPool)
+{
+    // Parquet is encoded straight into a pooled byte array, which is handed to the caller without another copy.
+    const auto outputStream = make_shared<PooledOutputStream>(outputBufferPool);
+    int status = WriteToParquet(table, outputStream, errorMessage, writeProperties, arrowWriteProperties);
+    if (status != 0)
+    {
+        return status;
+    }
+
+    outputStream->Detach(outputData, outputSize);
+    return 0;
+}
+
+// Arrow IPC file format is identical to feather v2, so the output can be read by either reader.
+int WriteToArrowIpc(const shared_ptr<arrow::Table> table, byte** outputData, int* outputSize, char* errorMessage)
+{
+    const shared_ptr<arrow::io::BufferOutputStream> outputStream = arrow::io::BufferOutputStream::Create().ValueOrDie();
+    arrow::Result<shared_ptr<arrow::ipc::RecordBatchWriter>> writerResult = arrow::ipc::MakeFileWriter(outputStream, table->schema());
+    if (!writerResult.ok())
+    {
+        string errorDetail = writerResult.status().ToString();
+        WriteErrorMessage(errorDetail, errorMessage);
+        return WriteToArrowError;
+    }
+
+    const shared_ptr<arrow::ipc::RecordBatchWriter> writer = writerResult.ValueOrDie();
+    auto status = writer->WriteTable(*table);
+    if (status.ok())
+    {
+        status = writer->Close();
+    }
+
+    if (!status.ok())
+    {
+        string errorDetail = status.ToString();
+        WriteErrorMessage(errorDetail, errorMessage);
+        return WriteToArrowError;
+    }
+
     shared_ptr<arrow::Buffer> outputBuffer = move(outputStream->Finish()).ValueOrDie();
-    const byte* bytes = reinterpret_cast<const byte*>(outputBuffer->data());
-    *outputSize = outputBuffer->size();
-    *outputData = new byte[*outputSize];
-    memcpy(*outputData, bytes, *outputSize);
+    CopyToOutput(outputBuffer, outputData, outputSize);
+
+    return 0;
+}
+
+// The exported stream keeps the record batches of table alive until the consumer releases it.
+int ExportToArrowStream(const shared_ptr<arrow::Table> table, struct ArrowArrayStream* outputStream, char* errorMessage)
+{
+    arrow::TableBatchReader tableReader(*table);
+    arrow::Result<arrow::RecordBatchVector> batchesResult = tableReader.ToRecordBatches();
+    if (!batchesResult.ok())
+    {
+        string errorDetail = batchesResult.status().ToString();
+        WriteErrorMessage(errorDetail, errorMessage);
+        return WriteToArrowError;
+    }
+
+    arrow::Result<shared_ptr<arrow::RecordBatchReader>> readerResult = arrow::RecordBatchReader::Make(batchesResult.ValueOrDie(), table->schema());
+    if (!readerResult.ok())
+    {
+        string errorDetail = readerResult.status().ToString();
+        WriteErrorMessage(errorDetail, errorMessage);
+        return WriteToArrowError;
+    }
+
+    const auto status = arrow::ExportRecordBatchReader(readerResult.ValueOrDie(), outputStream);
+    if (!status.ok())
+    {
+        string errorDetail = status.ToString();
+        WriteErrorMessage(errorDetail, errorMessage);
+        return WriteToArrowError;
+    }
 
     return 0;
 }
 
+// Dictionary encoding takes precedence over the column encoding, so it is disabled for columns with a recommended encoding.
+// Pages are encrypted and checksummed while they are encoded, so neither needs another pass over the output.
+shared_ptr<parquet::WriterProperties> BuildWriteProperties(const ColumnEncodings* columnEncodings, bool pageChecksum, const shared_ptr<parquet::FileEncryptionProperties>& encryption)
+{
+    parquet::WriterProperties::Builder builder;
+    builder.write_batch_size(ParquetOptions::WriteBatchSize)->compression(ParquetOptions::Compression)
+        ->max_row_group_length(ParquetOptions::MaxRowGroupLength);
+    if (columnEncodings != nullptr)
+    {
+        for (const auto& columnEncoding : *columnEncodings)
+        {
+            builder.disable_dictionary(columnEncoding.first)->encoding(columnEncoding.first, columnEncoding.second);
+        }
+    }
+
+#if ARROW_VERSION_MAJOR >= 13
+    if (pageChecksum)
+    {
+        builder.enable_page_checksum();
+    }
+#endif
+
+    if (encryption != nullptr)
+    {
+        builder.encryption(encryption);
+    }
+
+    return builder.build();
+}
+
 ParquetWriter::ParquetWriter()
 {
+    _nextJobId = 1;
+    _maxInFlightJobs = ParquetOptions::MaxInFlightJobs;
+    _pipelineChunkSize = ParquetOptions::PipelineChunkSize;
+    _pageChecksum = false;
+
     _readOptions = arrow::json::ReadOptions::Defaults();
     _readOptions.block_size = ParquetOptions::BlockSize;
     _readOptions.use_threads = ParquetOptions::UseThreads;
     _unexpectedFieldBehavior = ParquetOptions::UnexpectedFieldBehavior;
 
-    _writeProperties = parquet::WriterProperties::Builder()
-        .write_batch_size(ParquetOptions::WriteBatchSize)->compression(ParquetOptions::Compression)->build();
+    _writeProperties = BuildWriteProperties(nullptr);
+    _arrowWriteProperties = parquet::ArrowWriterProperties::Builder()
+        .set_use_threads(ParquetOptions::UseThreads)->build();
 }
 
-ParquetWriter::ParquetWriter(const unordered_map<string, string>& schemaData)
+ParquetWriter::ParquetWriter(const unordered_map<string, string>& schemaData) : ParquetWriter()
 {
     for (auto itr = schemaData.begin(); itr != schemaData.end(); itr ++)
     {
-        _schemaManager.AddSchema(itr->first, itr->second);
+        RegisterSchema(itr->first, itr->second);
     }
 }
 
+// Cancel all async jobs and wait until their callbacks return, so no job touches the writer after destruction.
+ParquetWriter::~ParquetWriter()
+{
+    unique_lock<mutex> lock(_jobMutex);
+    for (auto& job : _jobCancellations)
+    {
+        job.second->store(true);
+    }
+
+    _jobsDrained.wait(lock, [this] { return _jobCancellations.empty(); });
+}
+
 int ParquetWriter::RegisterSchema(const string& schemaKey, const string& schemaData)
 {
-    return _schemaManager.AddSchema(schemaKey, schemaData);
+    lock_guard<mutex> lock(_configurationMutex);
+    int status = _schemaManager.AddSchema(schemaKey, schemaData);
+    if (status == 0)
+    {
+        _schemaWriteProperties[schemaKey] = BuildWriteProperties(_schemaManager.GetColumnEncodings(schemaKey), _pageChecksum);
+        _flattenedPaths.erase(schemaKey);
+    }
+
+    return status;
 }
 
-int ParquetWriter::Write(const string& resourceType, const char* inputJson, int inputLength, byte** outputData, int* outputLength, char* errorMessage)
+int ParquetWriter::SetFlattenedPaths(const string& schemaKey, const vector<string>& paths, char* errorMessage)
 {
-    if (outputData == nullptr)
+    lock_guard<mutex> lock(_configurationMutex);
+    auto schema = _schemaManager.GetSchema(schemaKey);
+    if (schema == nullptr)
     {
-        WriteErrorMessage("Output data pointer is null.", errorMessage);
-        return WriteToParquetError;
+        WriteErrorMessage("Schema not found for '" + schemaKey + "'.", errorMessage);
+        return SchemaNotFound;
     }
 
-    if (outputLength == nullptr)
+    if (paths.empty())
     {
-        WriteErrorMessage("Output data size pointer is null.", errorMessage);
-        return WriteToParquetError;
+        _flattenedPaths.erase(schemaKey);
+        return 0;
     }
 
-    if (inputJson == nullptr)
+    string error;
+    if (!ValidateFlattenedPaths(*schema, paths, &error))
     {
-        WriteErrorMessage("Input Json data is null.", errorMessage);
-        return ReadInputJsonError;
+        WriteErrorMessage(error, errorMessage);
+        return ParseParquetSchemaError;
     }
-    
-    auto schema = _schemaManager.GetSchema(resourceType);
+
+    _flattenedPaths[schemaKey] = paths;
+    return 0;
+}
+
+int ParquetWriter::SetEncryptionKeys(const string& schemaKey, const EncryptionKeys& keys, char* errorMessage)
+{
+    lock_guard<mutex> lock(_configurationMutex);
+    auto schema = _schemaManager.GetSchema(schemaKey);
     if (schema == nullptr)
     {
-        WriteErrorMessage("Schema not found for '" + resourceType + "'.", errorMessage);
+        WriteErrorMessage("Schema not found for '" + schemaKey + "'.", errorMessage);
         return SchemaNotFound;
     }
 
+    if (keys.footerKey.empty() && keys.columnKeys.empty())
+    {
+        _encryptionKeys.erase(schemaKey);
+        return 0;
+    }
+
+    string error;
+    if (!ValidateEncryptionKeys(*schema, keys, &error))
+    {
+        WriteErrorMessage(error, errorMessage);
+        return InvalidEncryptionKeys;
+    }
+
+    _encryptionKeys[schemaKey] = keys;
+    return 0;
+}
+
+int ParquetWriter::SetPageChecksum(bool enabled, char* errorMessage)
+{
+#if ARROW_VERSION_MAJOR < 13
+    if (enabled)
+    {
+        WriteErrorMessage("Page checksums need arrow 13 or later.", errorMessage);
+        return PageChecksumNotSupported;
+    }
+#endif
+
+    lock_guard<mutex> lock(_configurationMutex);
+    _pageChecksum = enabled;
+    _writeProperties = BuildWriteProperties(nullptr, _pageChecksum);
+    for (auto& schemaWriteProperties : _schemaWriteProperties)
+    {
+        schemaWriteProperties.second = BuildWriteProperties(_schemaManager.GetColumnEncodings(schemaWriteProperties.first), _pageChecksum);
+    }
+
+    return 0;
+}
+
+// Prefixes that no longer match a registered schema are skipped, so those columns fall back to the footer key and stay encrypted.
+shared_ptr<parquet::WriterProperties> GetWriteProperties(const ConversionConfiguration& configuration)
+{
+    if (configuration.encrypted)
+    {
+        return BuildWriteProperties(&configuration.columnEncodings, configuration.pageChecksum, BuildEncryptionProperties(*configuration.schema, configuration.encryptionKeys, ""));
+    }
+
+    return configuration.writeProperties;
+}
+
+// Encrypted columns must exist in the file, so encryption follows the columns of the flattened table rather than the registered schema.
+shared_ptr<parquet::WriterProperties> GetFlattenedWriteProperties(const ConversionConfiguration& configuration, const string& path, const arrow::Schema& tableSchema)
+{
+    if (!configuration.encrypted)
+    {
+        return path.empty() ? configuration.writeProperties : configuration.defaultWriteProperties;
+    }
+
+    const ColumnEncodings* columnEncodings = path.empty() ? &configuration.columnEncodings : nullptr;
+    return BuildWriteProperties(columnEncodings, configuration.pageChecksum, BuildEncryptionProperties(tableSchema, configuration.encryptionKeys, path));
+}
+
+parquet::ReaderProperties GetReaderProperties(const ConversionConfiguration& configuration)
+{
+    parquet::ReaderProperties readerProperties = parquet::default_reader_properties();
+    if (configuration.encrypted)
+    {
+        readerProperties.file_decryption_properties(BuildDecryptionProperties(*configuration.schema, configuration.encryptionKeys, ""));
+    }
+
+    return readerProperties;
+}
+
+int ParquetWriter::GetConfiguration(const string& schemaKey, ConversionConfiguration* configuration, char* errorMessage)
+{
+    lock_guard<mutex> lock(_configurationMutex);
+    configuration->schema = _schemaManager.GetSchema(schemaKey);
+    if (configuration->schema == nullptr)
+    {
+        WriteErrorMessage("Schema not found for '" + schemaKey + "'.", errorMessage);
+        return SchemaNotFound;
+    }
+
+    const ColumnEncodings* columnEncodings = _schemaManager.GetColumnEncodings(schemaKey);
+    configuration->columnEncodings = columnEncodings == nullptr ? ColumnEncodings() : *columnEncodings;
+    auto writeProperties = _schemaWriteProperties.find(schemaKey);
+    configuration->writeProperties = writeProperties == _schemaWriteProperties.end() ? _writeProperties : writeProperties->second;
+    configuration->defaultWriteProperties = _writeProperties;
+
+    auto flattenedPaths = _flattenedPaths.find(schemaKey);
+    configuration->flattenedPaths = flattenedPaths == _flattenedPaths.end() ? vector<string>() : flattenedPaths->second;
+
+    auto keys = _encryptionKeys.find(schemaKey);
+    configuration->encrypted = keys != _encryptionKeys.end();
+    configuration->encryptionKeys = configuration->encrypted ? keys->second : EncryptionKeys();
+    configuration->pageChecksum = _pageChecksum;
+    configuration->pipelineChunkSize = _pipelineChunkSize;
+    return 0;
+}
+
+arrow::json::ParseOptions ParquetWriter::GetParseOptions(const ConversionConfiguration& configuration)
+{
     arrow::json::ParseOptions parseOptions = arrow::json::ParseOptions::Defaults();
-    parseOptions.explicit_schema = move(schema);
+    parseOptions.explicit_schema = configuration.schema;
     parseOptions.unexpected_field_behavior = _unexpectedFieldBehavior;
+    return parseOptions;
+}
 
+int ParquetWriter::ReadTable(const ConversionConfiguration& configuration, const char* inputJson, int inputLength, shared_ptr<arrow::Table>* table, char* errorMessage)
+{
+    const arrow::json::ParseOptions parseOptions = GetParseOptions(configuration);
     const auto bufferReader = make_shared<arrow::io::BufferReader>(reinterpret_cast<const uint8_t*>(inputJson), static_cast<int64_t>(inputLength));
     arrow::Result<shared_ptr<arrow::json::TableReader>> tableReaderResult = arrow::json::TableReader::Make(arrow::default_memory_pool(), bufferReader, _readOptions, parseOptions);
     
@@ -99,8 +385,755 @@ int ParquetWriter::Write(const string& resourceType, const char* inputJson, int
         return ReadInputJsonError;
     }
 
-    const shared_ptr<arrow::Table> table = tableResult.ValueOrDie();
-    return WriteToParquet(table, outputData, outputLength, errorMessage, _writeProperties);
+    *table = tableResult.ValueOrDie();
+    return 0;
+}
+
+int ParquetWriter::Write(const string& resourceType, const char* inputJson, int inputLength, byte** outputData, int* outputLength, char* errorMessage)
+{
+    if (outputData == nullptr)
+    {
+        WriteErrorMessage("Output data pointer is null.", errorMessage);
+        return WriteToParquetError;
+    }
+
+    if (outputLength == nullptr)
+    {
+        WriteErrorMessage("Output data size pointer is null.", errorMessage);
+        return WriteToParquetError;
+    }
+
+    if (inputJson == nullptr)
+    {
+        WriteErrorMessage("Input Json data is null.", errorMessage);
+        return ReadInputJsonError;
+    }
+
+    ConversionConfiguration configuration;
+    int status = GetConfiguration(resourceType, &configuration, errorMessage);
+    if (status != 0)
+    {
+        return status;
+    }
+
+    if (inputLength > configuration.pipelineChunkSize)
+    {
+        return WritePipelined(resourceType, configuration, inputJson, inputLength, outputData, outputLength, errorMessage);
+    }
+
+    // Parquet is encoded straight into a pooled byte array, which is handed to the caller without another copy.
+    const auto outputStream = make_shared<PooledOutputStream>(&_outputBufferPool);
+    status = ConvertToParquet(resourceType, configuration, inputJson, inputLength, outputStream, errorMessage);
+    if (status != 0)
+    {
+        return status;
+    }
+
+    outputStream->Detach(outputData, outputLength);
+    return 0;
+}
+
+int ParquetWriter::Write(const string& resourceType, InputFormat inputFormat, const char* inputJson, int inputLength, ParquetOutputSet* outputs, char* errorMessage)
+{
+    if (outputs == nullptr)
+    {
+        WriteErrorMessage("Output set pointer is null.", errorMessage);
+        return WriteToParquetError;
+    }
+
+    if (inputJson == nullptr)
+    {
+        WriteErrorMessage("Input Json data is null.", errorMessage);
+        return ReadInputJsonError;
+    }
+
+    string error;
+    switch (inputFormat)
+    {
+        case Ndjson:
+            return WriteToOutputSet(resourceType, inputJson, inputLength, outputs, errorMessage);
+        case JsonArray:
+        {
+            string ndjson;
+            if (!JsonArrayToNdjson(inputJson, inputLength, &ndjson, &error))
+            {
+                WriteErrorMessage(error, errorMessage);
+                return ReadInputJsonError;
+            }
+
+            return WriteToOutputSet(resourceType, ndjson.c_str(), static_cast<int>(ndjson.size()), outputs, errorMessage);
+        }
+        case Bundle:
+        {
+            map<string, string> ndjsonByResourceType;
+            if (!BundleToNdjson(inputJson, inputLength, &ndjsonByResourceType, &error))
+            {
+                WriteErrorMessage(error, errorMessage);
+                return ReadInputJsonError;
+            }
+
+            return WriteToOutputSet(ndjsonByResourceType, outputs, errorMessage);
+        }
+        case MixedNdjson:
+        {
+            map<string, string> ndjsonByResourceType;
+            if (!SplitNdjsonByResourceType(inputJson, inputLength, &ndjsonByResourceType, &error))
+            {
+                WriteErrorMessage(error, errorMessage);
+                return ReadInputJsonError;
+            }
+
+            return WriteToOutputSet(ndjsonByResourceType, outputs, errorMessage);
+        }
+        default:
+            WriteErrorMessage("Unknown input format " + to_string(inputFormat) + ".", errorMessage);
+            return ReadInputJsonError;
+    }
+}
+
+// Progress of the resource types of an output set conversion, shared with the executor tasks that help convert them.
+struct OutputSetProgress
+{
+    atomic<size_t> nextInput;
+    size_t completedCount;
+    mutex completedMutex;
+    condition_variable completed;
+};
+
+// Resource types are converted on the calling thread and on up to AsyncThreadCount - 1 tasks of the writer's executor, outputs are
+// added in resource type order once all conversions are done. Each conversion already parses and encodes on the arrow cpu pool,
+// so no threads are created per call. A task that starts after every resource type is taken returns without touching the inputs.
+// Resource types without a registered schema are skipped and reported in the output set, so they don't fail the other types.
+int ParquetWriter::WriteToOutputSet(const map<string, string>& ndjsonByResourceType, ParquetOutputSet* outputs, char* errorMessage)
+{
+    vector<const pair<const string, string>*> inputs;
+    for (const auto& ndjson : ndjsonByResourceType)
+    {
+        inputs.push_back(&ndjson);
+    }
+
+    const size_t inputCount = inputs.size();
+    vector<vector<pair<string, shared_ptr<arrow::Buffer>>>> typeOutputs(inputCount);
+    vector<int> statuses(inputCount, 0);
+    vector<array<char, 256>> errorMessages(inputCount);
+    const auto progress = make_shared<OutputSetProgress>();
+    progress->nextInput = 0;
+    progress->completedCount = 0;
+    auto convert = [this, inputCount, progress, &inputs, &typeOutputs, &statuses, &errorMessages]()
+    {
+        for (size_t i = progress->nextInput++; i < inputCount; i = progress->nextInput++)
+        {
+            errorMessages[i][0] = '\0';
+            statuses[i] = WriteToBuffers(inputs[i]->first, inputs[i]->second.c_str(), static_cast<int>(inputs[i]->second.size()), &typeOutputs[i], errorMessages[i].data());
+
+            lock_guard<mutex> lock(progress->completedMutex);
+            progress->completedCount++;
+            progress->completed.notify_all();
+        }
+    };
+
+    if (inputCount > 1)
+    {
+        lock_guard<mutex> lock(_jobMutex);
+        if (CreateExecutor(errorMessage) != 0)
+        {
+            return WriteToParquetError;
+        }
+
+        for (size_t i = 1; i < min(inputCount, static_cast<size_t>(ParquetOptions::AsyncThreadCount)); i++)
+        {
+            // Spawn failures only mean fewer helpers, the calling thread converts the remaining types.
+            ARROW_UNUSED(_executor->Spawn(convert));
+        }
+    }
+
+    convert();
+    {
+        unique_lock<mutex> lock(progress->completedMutex);
+        progress->completed.wait(lock, [&progress, inputCount] { return progress->completedCount == inputCount; });
+    }
+
+    for (size_t i = 0; i < inputCount; i++)
+    {
+        if (statuses[i] != 0 && statuses[i] != SchemaNotFound)
+        {
+            WriteErrorMessage(errorMessages[i].data(), errorMessage);
+            return statuses[i];
+        }
+    }
+
+    for (size_t i = 0; i < inputCount; i++)
+    {
+        if (statuses[i] == SchemaNotFound)
+        {
+            outputs->AddSkipped(inputs[i]->first);
+            continue;
+        }
+
+        for (const auto& output : typeOutputs[i])
+        {
+            outputs->Add(output.first, output.second);
+        }
+    }
+
+    return 0;
+}
+
+int ParquetWriter::WriteToOutputSet(const string& resourceType, const char* inputJson, int inputLength, ParquetOutputSet* outputs, char* errorMessage)
+{
+    vector<pair<string, shared_ptr<arrow::Buffer>>> typeOutputs;
+    int status = WriteToBuffers(resourceType, inputJson, inputLength, &typeOutputs, errorMessage);
+    if (status != 0)
+    {
+        return status;
+    }
+
+    for (const auto& output : typeOutputs)
+    {
+        outputs->Add(output.first, output.second);
+    }
+
+    return 0;
+}
+
+int ParquetWriter::WriteToBuffers(const string& resourceType, const char* inputJson, int inputLength, vector<pair<string, shared_ptr<arrow::Buffer>>>* outputs, char* errorMessage)
+{
+    ConversionConfiguration configuration;
+    int status = GetConfiguration(resourceType, &configuration, errorMessage);
+    if (status != 0)
+    {
+        return status;
+    }
+
+    if (!configuration.flattenedPaths.empty())
+    {
+        return WriteFlattened(resourceType, configuration, inputJson, inputLength, outputs, errorMessage);
+    }
+
+    // Outputs of a set are owned by the set and may outlive the writer, so they are not taken from the output buffer pool.
+    const shared_ptr<arrow::io::BufferOutputStream> outputStream = arrow::io::BufferOutputStream::Create().ValueOrDie();
+    status = ConvertToParquet(resourceType, configuration, inputJson, inputLength, outputStream, errorMessage);
+    if (status != 0)
+    {
+        return status;
+    }
+
+    outputs->push_back(make_pair(resourceType, outputStream->Finish().ValueOrDie()));
+    return 0;
+}
+
+int ParquetWriter::WriteFlattened(const string& resourceType, const ConversionConfiguration& configuration, const char* inputJson, int inputLength, vector<pair<string, shared_ptr<arrow::Buffer>>>* outputs, char* errorMessage)
+{
+    const vector<string>& paths = configuration.flattenedPaths;
+    const auto parseStart = chrono::steady_clock::now();
+    shared_ptr<arrow::Table> table;
+    int status = ReadTable(configuration, inputJson, inputLength, &table, errorMessage);
+    if (status != 0)
+    {
+        return status;
+    }
+
+    const auto encodeStart = chrono::steady_clock::now();
+    shared_ptr<arrow::Table> parentTable;
+    vector<shared_ptr<arrow::Table>> childTables;
+    const auto flattenStatus = FlattenTable(table, paths, &parentTable, &childTables);
+    if (!flattenStatus.ok())
+    {
+        WriteErrorMessage(flattenStatus.ToString(), errorMessage);
+        return WriteToParquetError;
+    }
+
+    // Child tables have their own column paths, so they are written without the column encodings of the schema.
+    int64_t outputLength = 0;
+    for (size_t i = 0; i <= childTables.size(); i++)
+    {
+        const shared_ptr<arrow::io::BufferOutputStream> outputStream = arrow::io::BufferOutputStream::Create().ValueOrDie();
+        status = i == 0
+            ? WriteToParquet(parentTable, outputStream, errorMessage, GetFlattenedWriteProperties(configuration, "", *parentTable->schema()), _arrowWriteProperties)
+            : WriteToParquet(childTables[i - 1], outputStream, errorMessage, GetFlattenedWriteProperties(configuration, paths[i - 1], *childTables[i - 1]->schema()), _arrowWriteProperties);
+        if (status != 0)
+        {
+            return status;
+        }
+
+        const auto output = outputStream->Finish().ValueOrDie();
+        outputLength += output->size();
+        outputs->push_back(make_pair(i == 0 ? resourceType : GetFlattenedTableName(resourceType, paths[i - 1]), output));
+    }
+
+    const auto encodeEnd = chrono::steady_clock::now();
+    _statistics.Record(resourceType, inputLength, table->num_rows(), outputLength,
+        chrono::duration<double>(encodeStart - parseStart).count(), chrono::duration<double>(encodeEnd - encodeStart).count());
+    return 0;
+}
+
+// Parse and encode one after the other, the phases are timed separately for the conversion statistics.
+int ParquetWriter::ConvertToParquet(const string& resourceType, const ConversionConfiguration& configuration, const char* inputJson, int inputLength, const shared_ptr<arrow::io::OutputStream>& outputStream, char* errorMessage, const atomic<bool>* cancelled)
+{
+    const auto parseStart = chrono::steady_clock::now();
+    shared_ptr<arrow::Table> table;
+    int status = ReadTable(configuration, inputJson, inputLength, &table, errorMessage);
+    if (status != 0)
+    {
+        return status;
+    }
+
+    if (cancelled != nullptr && cancelled->load())
+    {
+        return ConversionCancelled;
+    }
+
+    const auto encodeStart = chrono::steady_clock::now();
+    status = WriteToParquet(table, outputStream, errorMessage, GetWriteProperties(configuration), _arrowWriteProperties);
+    if (status != 0)
+    {
+        return status;
+    }
+
+    const auto encodeEnd = chrono::steady_clock::now();
+    _statistics.Record(resourceType, inputLength, table->num_rows(), outputStream->Tell().ValueOr(0),
+        chrono::duration<double>(encodeStart - parseStart).count(), chrono::duration<double>(encodeEnd - encodeStart).count());
+    return 0;
+}
+
+#if ARROW_VERSION_MAJOR >= 11
+// Length of the longest line of input, the streaming json reader fails on a line that does not fit in one block.
+int64_t GetLongestLineLength(const char* input, int64_t length)
+{
+    int64_t longestLine = 0;
+    const char* lineStart = input;
+    const char* inputEnd = input + length;
+    while (lineStart < inputEnd)
+    {
+        const void* lineEnd = memchr(lineStart, '\n', inputEnd - lineStart);
+        const char* next = lineEnd == nullptr ? inputEnd : static_cast<const char*>(lineEnd) + 1;
+        longestLine = max(longestLine, static_cast<int64_t>(next - lineStart));
+        lineStart = next;
+    }
+
+    return longestLine;
+}
+
+int ParquetWriter::ParseStreamed(const ConversionConfiguration& configuration, const char* inputJson, int inputLength, BoundedQueue<shared_ptr<arrow::Table>>* parsedChunks, double* parseSeconds, char* errorMessage)
+{
+    // Blocks are parsed one at a time on the calling thread, so no more than the queued chunks are parsed ahead of the encoder.
+    arrow::json::ReadOptions readOptions = _readOptions;
+    readOptions.block_size = configuration.pipelineChunkSize;
+    readOptions.use_threads = false;
+    const auto bufferReader = make_shared<arrow::io::BufferReader>(reinterpret_cast<const uint8_t*>(inputJson), static_cast<int64_t>(inputLength));
+
+    auto parseStart = chrono::steady_clock::now();
+    arrow::Result<shared_ptr<arrow::json::StreamingReader>> readerResult = arrow::json::StreamingReader::Make(bufferReader, readOptions, GetParseOptions(configuration));
+    arrow::Status status = readerResult.status();
+    shared_ptr<arrow::RecordBatch> batch;
+    while (status.ok())
+    {
+        status = readerResult.ValueOrDie()->ReadNext(&batch);
+        *parseSeconds += chrono::duration<double>(chrono::steady_clock::now() - parseStart).count();
+        if (!status.ok() || batch == nullptr)
+        {
+            break;
+        }
+
+        arrow::Result<shared_ptr<arrow::Table>> tableResult = arrow::Table::FromRecordBatches({ batch });
+        status = tableResult.status();
+        if (!status.ok() || !parsedChunks->Push(tableResult.ValueOrDie()))
+        {
+            break;
+        }
+
+        parseStart = chrono::steady_clock::now();
+    }
+
+    if (!status.ok())
+    {
+        WriteErrorMessage(status.ToString(), errorMessage);
+        return ReadInputJsonError;
+    }
+
+    return 0;
+}
+#endif
+
+int ParquetWriter::ParseChunked(const ConversionConfiguration& configuration, const char* inputJson, int inputLength, BoundedQueue<shared_ptr<arrow::Table>>* parsedChunks, double* parseSeconds, char* errorMessage)
+{
+    const int chunkSize = configuration.pipelineChunkSize;
+    const char* chunkStart = inputJson;
+    const char* inputEnd = inputJson + inputLength;
+    while (chunkStart < inputEnd)
+    {
+        // Extend each chunk to the end of the line so every chunk is valid ndjson.
+        const char* chunkEnd = inputEnd;
+        if (inputEnd - chunkStart > chunkSize)
+        {
+            const void* lineEnd = memchr(chunkStart + chunkSize, '\n', inputEnd - chunkStart - chunkSize);
+            chunkEnd = lineEnd == nullptr ? inputEnd : static_cast<const char*>(lineEnd) + 1;
+        }
+
+        // Skip chunks of blank lines, they hold no rows.
+        if (all_of(chunkStart, chunkEnd, [](char c) { return isspace(static_cast<unsigned char>(c)); }))
+        {
+            chunkStart = chunkEnd;
+            continue;
+        }
+
+        const auto parseStart = chrono::steady_clock::now();
+        shared_ptr<arrow::Table> table;
+        const int status = ReadTable(configuration, chunkStart, static_cast<int>(chunkEnd - chunkStart), &table, errorMessage);
+        *parseSeconds += chrono::duration<double>(chrono::steady_clock::now() - parseStart).count();
+        if (status != 0)
+        {
+            return status;
+        }
+
+        if (!parsedChunks->Push(table))
+        {
+            break;
+        }
+
+        chunkStart = chunkEnd;
+    }
+
+    return 0;
+}
+
+int ParquetWriter::WritePipelined(const string& resourceType, const ConversionConfiguration& configuration, const char* inputJson, int inputLength, byte** outputData, int* outputLength, char* errorMessage)
+{
+    const auto outputStream = make_shared<PooledOutputStream>(&_outputBufferPool);
+    unique_ptr<parquet::arrow::FileWriter> fileWriter;
+    auto writeStatus = parquet::arrow::FileWriter::Open(*configuration.schema, arrow::default_memory_pool(), outputStream, GetWriteProperties(configuration), _arrowWriteProperties, &fileWriter);
+    if (!writeStatus.ok())
+    {
+        WriteErrorMessage(writeStatus.ToString(), errorMessage);
+        return WriteToParquetError;
+    }
+
+    BoundedQueue<shared_ptr<arrow::Table>> parsedChunks(ParquetOptions::PipelineQueueSize);
+    int parseStatus = 0;
+    char parseErrorMessage[256] = "";
+    double parseSeconds = 0;
+    thread parser([&]()
+    {
+        // An input of only blank lines is parsed as a whole, so it fails the same way as without the pipeline.
+        if (all_of(inputJson, inputJson + inputLength, [](char c) { return isspace(static_cast<unsigned char>(c)); }))
+        {
+            shared_ptr<arrow::Table> table;
+            parseStatus = ReadTable(configuration, inputJson, inputLength, &table, parseErrorMessage);
+            if (parseStatus == 0)
+            {
+                parsedChunks.Push(table);
+            }
+        }
+#if ARROW_VERSION_MAJOR >= 11
+        else if (GetLongestLineLength(inputJson, inputLength) <= configuration.pipelineChunkSize)
+        {
+            parseStatus = ParseStreamed(configuration, inputJson, inputLength, &parsedChunks, &parseSeconds, parseErrorMessage);
+        }
+#endif
+        else
+        {
+            parseStatus = ParseChunked(configuration, inputJson, inputLength, &parsedChunks, &parseSeconds, parseErrorMessage);
+        }
+
+        parsedChunks.Close();
+    });
+
+    shared_ptr<arrow::Table> table;
+    long long rowCount = 0;
+    double encodeSeconds = 0;
+    while (parsedChunks.Pop(&table))
+    {
+        const auto encodeStart = chrono::steady_clock::now();
+        rowCount += table->num_rows();
+        writeStatus = WriteRowGroup(fileWriter.get(), *table);
+        encodeSeconds += chrono::duration<double>(chrono::steady_clock::now() - encodeStart).count();
+        if (!writeStatus.ok())
+        {
+            parsedChunks.Cancel();
+            break;
+        }
+    }
+
+    parser.join();
+    if (parseStatus != 0)
+    {
+        WriteErrorMessage(parseErrorMessage, errorMessage);
+        return parseStatus;
+    }
+
+    if (writeStatus.ok())
+    {
+        writeStatus = fileWriter->Close();
+    }
+
+    if (!writeStatus.ok())
+    {
+        WriteErrorMessage(writeStatus.ToString(), errorMessage);
+        return WriteToParquetError;
+    }
+
+    outputStream->Detach(outputData, outputLength);
+    _statistics.Record(resourceType, inputLength, rowCount, *outputLength, parseSeconds, encodeSeconds);
+    return 0;
+}
+
+int ParquetWriter::GetStatistics(const string& schemaKey, ConversionStatistics* statistics)
+{
+    return _statistics.Get(schemaKey, statistics) ? 0 : ConversionStatisticsNotFound;
+}
+
+int ParquetWriter::GetRecommendedBatchSize(const string& schemaKey, long long targetOutputBytes, int targetLatencyMilliseconds, long long* inputBytes, long long* rows)
+{
+    int pipelineChunkSize;
+    {
+        lock_guard<mutex> lock(_configurationMutex);
+        pipelineChunkSize = _pipelineChunkSize;
+    }
+
+    return _statistics.RecommendBatchSize(schemaKey, targetOutputBytes, targetLatencyMilliseconds, pipelineChunkSize, inputBytes, rows) ? 0 : ConversionStatisticsNotFound;
+}
+
+void ParquetWriter::ReleaseOutput(byte* outputData)
+{
+    if (outputData != nullptr && !_outputBufferPool.ReleaseOutput(outputData))
+    {
+        delete[] outputData;
+    }
+}
+
+int ParquetWriter::SetPipelineChunkSize(int pipelineChunkSize)
+{
+    if (pipelineChunkSize <= 0)
+    {
+        return WriteToParquetError;
+    }
+
+    lock_guard<mutex> lock(_configurationMutex);
+    _pipelineChunkSize = pipelineChunkSize;
+    return 0;
+}
+
+int ParquetWriter::WriteArrowIpc(const string& resourceType, const char* inputJson, int inputLength, byte** outputData, int* outputLength, char* errorMessage)
+{
+    if (outputData == nullptr)
+    {
+        WriteErrorMessage("Output data pointer is null.", errorMessage);
+        return WriteToArrowError;
+    }
+
+    if (outputLength == nullptr)
+    {
+        WriteErrorMessage("Output data size pointer is null.", errorMessage);
+        return WriteToArrowError;
+    }
+
+    if (inputJson == nullptr)
+    {
+        WriteErrorMessage("Input Json data is null.", errorMessage);
+        return ReadInputJsonError;
+    }
+
+    ConversionConfiguration configuration;
+    int status = GetConfiguration(resourceType, &configuration, errorMessage);
+    if (status != 0)
+    {
+        return status;
+    }
+
+    shared_ptr<arrow::Table> table;
+    status = ReadTable(configuration, inputJson, inputLength, &table, errorMessage);
+    if (status != 0)
+    {
+        return status;
+    }
+
+    return WriteToArrowIpc(table, outputData, outputLength, errorMessage);
+}
+
+int ParquetWriter::WriteArrowStream(const string& resourceType, const char* inputJson, int inputLength, struct ArrowArrayStream* outputStream, char* errorMessage)
+{
+    if (outputStream == nullptr)
+    {
+        WriteErrorMessage("Output stream pointer is null.", errorMessage);
+        return WriteToArrowError;
+    }
+
+    if (inputJson == nullptr)
+    {
+        WriteErrorMessage("Input Json data is null.", errorMessage);
+        return ReadInputJsonError;
+    }
+
+    ConversionConfiguration configuration;
+    int status = GetConfiguration(resourceType, &configuration, errorMessage);
+    if (status != 0)
+    {
+        return status;
+    }
+
+    shared_ptr<arrow::Table> table;
+    status = ReadTable(configuration, inputJson, inputLength, &table, errorMessage);
+    if (status != 0)
+    {
+        return status;
+    }
+
+    return ExportToArrowStream(table, outputStream, errorMessage);
+}
+
+int ParquetWriter::WriteAsync(const string& resourceType, const char* inputJson, int inputLength, ConversionCallback callback, void* state, long long* jobId, char* errorMessage)
+{
+    if (callback == nullptr)
+    {
+        WriteErrorMessage("Conversion callback is null.", errorMessage);
+        return WriteToParquetError;
+    }
+
+    if (jobId == nullptr)
+    {
+        WriteErrorMessage("Job id pointer is null.", errorMessage);
+        return WriteToParquetError;
+    }
+
+    if (inputJson == nullptr)
+    {
+        WriteErrorMessage("Input Json data is null.", errorMessage);
+        return ReadInputJsonError;
+    }
+
+    // The job converts with the configuration from when it was queued.
+    ConversionConfiguration configuration;
+    int configurationStatus = GetConfiguration(resourceType, &configuration, errorMessage);
+    if (configurationStatus != 0)
+    {
+        return configurationStatus;
+    }
+
+    lock_guard<mutex> lock(_jobMutex);
+    if (static_cast<int>(_jobCancellations.size()) >= _maxInFlightJobs)
+    {
+        WriteErrorMessage("Too many conversions in flight, the limit is " + to_string(_maxInFlightJobs) + ".", errorMessage);
+        return TooManyInFlightConversions;
+    }
+
+    if (CreateExecutor(errorMessage) != 0)
+    {
+        return WriteToParquetError;
+    }
+
+    const long long newJobId = _nextJobId++;
+    const auto cancelled = make_shared<atomic<bool>>(false);
+    const auto status = _executor->Spawn([this, newJobId, resourceType, configuration, inputJson, inputLength, callback, state, cancelled]()
+    {
+        RunAsyncJob(newJobId, resourceType, configuration, inputJson, inputLength, callback, state, cancelled);
+    });
+
+    if (!status.ok())
+    {
+        WriteErrorMessage(status.ToString(), errorMessage);
+        return WriteToParquetError;
+    }
+
+    _jobCancellations[newJobId] = cancelled;
+    *jobId = newJobId;
+    return 0;
+}
+
+int ParquetWriter::CreateExecutor(char* errorMessage)
+{
+    if (_executor != nullptr)
+    {
+        return 0;
+    }
+
+    arrow::Result<shared_ptr<arrow::internal::ThreadPool>> executorResult = arrow::internal::ThreadPool::Make(ParquetOptions::AsyncThreadCount);
+    if (!executorResult.ok())
+    {
+        WriteErrorMessage(executorResult.status().ToString(), errorMessage);
+        return WriteToParquetError;
+    }
+
+    _executor = executorResult.ValueOrDie();
+    return 0;
+}
+
+// The job stays in flight until its callback returns, so slow consumers also count against the in-flight limit.
+void ParquetWriter::RunAsyncJob(long long jobId, const string& resourceType, const ConversionConfiguration& configuration, const char* inputJson, int inputLength, ConversionCallback callback, void* state, const shared_ptr<atomic<bool>>& cancelled)
+{
+    byte* outputData = nullptr;
+    int outputLength = 0;
+    char errorMessage[256] = "";
+
+    int status = ConversionCancelled;
+    if (!cancelled->load())
+    {
+        const auto outputStream = make_shared<PooledOutputStream>(&_outputBufferPool);
+        status = ConvertToParquet(resourceType, configuration, inputJson, inputLength, outputStream, errorMessage, cancelled.get());
+        if (status == 0)
+        {
+            outputStream->Detach(&outputData, &outputLength);
+        }
+    }
+
+    if (status == ConversionCancelled)
+    {
+        WriteErrorMessage("Conversion job " + to_string(jobId) + " was cancelled.", errorMessage);
+    }
+
+    callback(jobId, status, outputData, outputLength, errorMessage, state);
+
+    lock_guard<mutex> lock(_jobMutex);
+    _jobCancellations.erase(jobId);
+    if (_jobCancellations.empty())
+    {
+        _jobsDrained.notify_all();
+    }
+}
+
+int ParquetWriter::CancelAsync(long long jobId)
+{
+    lock_guard<mutex> lock(_jobMutex);
+    auto itr = _jobCancellations.find(jobId);
+    if (itr == _jobCancellations.end())
+    {
+        return ConversionJobNotFound;
+    }
+
+    itr->second->store(true);
+    return 0;
+}
+
+int ParquetWriter::SetMaxInFlightJobs(int maxInFlightJobs)
+{
+    if (maxInFlightJobs <= 0)
+    {
+        return TooManyInFlightConversions;
+    }
+
+    lock_guard<mutex> lock(_jobMutex);
+    _maxInFlightJobs = maxInFlightJobs;
+    return 0;
+}
+
+int ParquetWriter::Compact(const string& schemaKey, const InputFileFactory& openInput, int inputCount, const OutputStreamFactory& openOutput, int64_t targetFileSize, int* outputCount, char* errorMessage)
+{
+    if (outputCount == nullptr)
+    {
+        WriteErrorMessage("Output count pointer is null.", errorMessage);
+        return WriteToParquetError;
+    }
+
+    ConversionConfiguration configuration;
+    int status = GetConfiguration(schemaKey, &configuration, errorMessage);
+    if (status != 0)
+    {
+        return status;
+    }
+
+    // Encrypted inputs and outputs get their own properties per file.
+    ParquetCompactor compactor(configuration.schema, [configuration]() { return GetReaderProperties(configuration); }, [configuration]() { return GetWriteProperties(configuration); },
+        _arrowWriteProperties, openOutput, targetFileSize);
+    return compactor.Compact(openInput, inputCount, outputCount, errorMessage);
 }
 
 void WriteErrorMessage(const string& errorMessage, char* outputErrorMessage)
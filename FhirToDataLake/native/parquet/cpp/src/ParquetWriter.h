@@ -1,8 +1,24 @@
 #pragma once
 #include <arrow/api.h>
+#include <arrow/c/abi.h>
+#include <arrow/io/api.h>
+#include <arrow/util/config.h>
+#include <arrow/util/thread_pool.h>
+#include <atomic>
+#include <condition_variable>
+#include <map>
+#include <mutex>
 #include <unordered_map>
 #include <string>
+#include "BoundedQueue.h"
 #include "SchemaManager.h"
+#include "ParquetCompactor.h"
+#include "OutputBufferPool.h"
+#include "ParquetOutputSet.h"
+#include "JsonInput.h"
+#include "TableFlattener.h"
+#include "ParquetEncryption.h"
+#include "ConversionStatistics.h"
 #include "ParquetOptions.h"
 #include "ErrorCodes.h"
 
@@ -10,24 +26,173 @@ using namespace std;
 
 typedef unsigned char byte;
 
-int WriteToParquet(const shared_ptr<arrow::Table> table, byte** outputData, int* outputSize, char* errorMessage, const shared_ptr<parquet::WriterProperties> writeProperties);
+// Completion callback of an async conversion, outputData is owned by the callee and released with ReleaseParquetOutput.
+typedef void (*ConversionCallback)(long long jobId, int status, byte* outputData, int outputLength, const char* errorMessage, void* state);
+
+// Configuration of a schema key as one conversion sees it. It is copied under the configuration lock when the conversion starts,
+// so registering schemas or setting keys meanwhile doesn't change a conversion in flight.
+struct ConversionConfiguration
+{
+    shared_ptr<arrow::Schema> schema;
+    ColumnEncodings columnEncodings;
+    // Write properties with the column encodings of the schema, and for tables without them, both without encryption.
+    shared_ptr<parquet::WriterProperties> writeProperties;
+    shared_ptr<parquet::WriterProperties> defaultWriteProperties;
+    vector<string> flattenedPaths;
+    bool encrypted;
+    EncryptionKeys encryptionKeys;
+    bool pageChecksum;
+    int pipelineChunkSize;
+};
+
+shared_ptr<parquet::WriterProperties> BuildWriteProperties(const ColumnEncodings* columnEncodings, bool pageChecksum=false, const shared_ptr<parquet::FileEncryptionProperties>& encryption=nullptr);
+void CopyToOutput(const shared_ptr<arrow::Buffer>& buffer, byte** outputData, int* outputSize);
+arrow::Status WriteRowGroup(parquet::arrow::FileWriter* fileWriter, const arrow::Table& table);
+int WriteToParquet(const shared_ptr<arrow::Table> table, const shared_ptr<arrow::io::OutputStream>& outputStream, char* errorMessage, const shared_ptr<parquet::WriterProperties> writeProperties, const shared_ptr<parquet::ArrowWriterProperties> arrowWriteProperties);
+int WriteToParquet(const shared_ptr<arrow::Table> table, byte** outputData, int* outputSize, char* errorMessage, const shared_ptr<parquet::WriterProperties> writeProperties, const shared_ptr<parquet::ArrowWriterProperties> arrowWriteProperties, OutputBufferPool* outputBufferPool);
+int WriteToArrowIpc(const shared_ptr<arrow::Table> table, byte** outputData, int* outputSize, char* errorMessage);
+int ExportToArrowStream(const shared_ptr<arrow::Table> table, struct ArrowArrayStream* outputStream, char* errorMessage);
 void WriteErrorMessage(const string& errorMessage, char* outputErrorMessage);
 
+// Write properties for outputs of the resource table, encryption properties are built for every call.
+shared_ptr<parquet::WriterProperties> GetWriteProperties(const ConversionConfiguration& configuration);
+
+// Write properties of the child table of a flattened path, or of the resource table if path is empty.
+shared_ptr<parquet::WriterProperties> GetFlattenedWriteProperties(const ConversionConfiguration& configuration, const string& path, const arrow::Schema& tableSchema);
+
+// Reader properties for parquet outputs of the resource table, with decryption properties if the outputs are encrypted.
+parquet::ReaderProperties GetReaderProperties(const ConversionConfiguration& configuration);
+
 class ParquetWriter
 {
     private:
+        // Guards the configuration below, which conversions copy with GetConfiguration.
+        mutex _configurationMutex;
         SchemaManager _schemaManager;
         arrow::json::ReadOptions _readOptions;
         arrow::json::UnexpectedFieldBehavior _unexpectedFieldBehavior;
         shared_ptr<parquet::WriterProperties> _writeProperties;
+        // Write properties with the column encodings of each registered schema.
+        unordered_map<string, shared_ptr<parquet::WriterProperties>> _schemaWriteProperties;
+        // Repeated paths promoted to child tables in output set conversions of each schema key.
+        unordered_map<string, vector<string>> _flattenedPaths;
+        // Modular encryption keys of each schema key, they are kept when the schema is registered again.
+        unordered_map<string, EncryptionKeys> _encryptionKeys;
+        bool _pageChecksum;
+        int _pipelineChunkSize;
+        shared_ptr<parquet::ArrowWriterProperties> _arrowWriteProperties;
+        OutputBufferPool _outputBufferPool;
+        ConversionStatisticsTracker _statistics;
+
+        // Async conversions and the resource types of output set conversions run on a dedicated executor, so they never wait on
+        // the arrow cpu pool from inside it.
+        shared_ptr<arrow::internal::ThreadPool> _executor;
+        mutex _jobMutex;
+        condition_variable _jobsDrained;
+        unordered_map<long long, shared_ptr<atomic<bool>>> _jobCancellations;
+        long long _nextJobId;
+        int _maxInFlightJobs;
+
+        // Copy the configuration of schemaKey, returns SchemaNotFound if schemaKey is not registered.
+        int GetConfiguration(const string& schemaKey, ConversionConfiguration* configuration, char* errorMessage);
+
+        // Parse and encode input json in one row group, cancelled is checked between the two phases.
+        int ConvertToParquet(const string& resourceType, const ConversionConfiguration& configuration, const char* inputJson, int inputLength, const shared_ptr<arrow::io::OutputStream>& outputStream, char* errorMessage, const atomic<bool>* cancelled=nullptr);
+
+        // Convert input ndjson of resource type and add the parquet bytes to outputs.
+        int WriteToOutputSet(const string& resourceType, const char* inputJson, int inputLength, ParquetOutputSet* outputs, char* errorMessage);
+
+        // Convert input ndjson of resource type to parquet bytes that are not taken from the output buffer pool,
+        // one output for the resource type and one per flattened path of the resource type.
+        int WriteToBuffers(const string& resourceType, const char* inputJson, int inputLength, vector<pair<string, shared_ptr<arrow::Buffer>>>* outputs, char* errorMessage);
+
+        // Convert input ndjson of resource type with the flattened paths promoted to child tables.
+        int WriteFlattened(const string& resourceType, const ConversionConfiguration& configuration, const char* inputJson, int inputLength, vector<pair<string, shared_ptr<arrow::Buffer>>>* outputs, char* errorMessage);
+
+        // Convert the ndjson of each resource type in parallel on the executor and add the parquet bytes to outputs keyed by resource type.
+        int WriteToOutputSet(const map<string, string>& ndjsonByResourceType, ParquetOutputSet* outputs, char* errorMessage);
+
+        // Parse input json in chunks on a separate thread and encode each parsed chunk as a row group meanwhile.
+        int WritePipelined(const string& resourceType, const ConversionConfiguration& configuration, const char* inputJson, int inputLength, byte** outputData, int* outputLength, char* errorMessage);
+
+#if ARROW_VERSION_MAJOR >= 11
+        // Push the record batches of the arrow streaming json reader into parsedChunks, each batch is a block of about the chunk size.
+        // Every line of the input must fit in a block.
+        int ParseStreamed(const ConversionConfiguration& configuration, const char* inputJson, int inputLength, BoundedQueue<shared_ptr<arrow::Table>>* parsedChunks, double* parseSeconds, char* errorMessage);
+#endif
+
+        // Push newline aligned chunks of about the chunk size parsed with a table reader into parsedChunks, a line longer than a chunk is a chunk of its own.
+        int ParseChunked(const ConversionConfiguration& configuration, const char* inputJson, int inputLength, BoundedQueue<shared_ptr<arrow::Table>>* parsedChunks, double* parseSeconds, char* errorMessage);
+
+        // Create the executor on first use, the caller holds _jobMutex.
+        int CreateExecutor(char* errorMessage);
+
+        void RunAsyncJob(long long jobId, const string& resourceType, const ConversionConfiguration& configuration, const char* inputJson, int inputLength, ConversionCallback callback, void* state, const shared_ptr<atomic<bool>>& cancelled);
+
+        // Json parse options with the schema of configuration.
+        arrow::json::ParseOptions GetParseOptions(const ConversionConfiguration& configuration);
+
+        // Parse input json to an arrow table with the schema of configuration.
+        int ReadTable(const ConversionConfiguration& configuration, const char* inputJson, int inputLength, shared_ptr<arrow::Table>* table, char* errorMessage);
 
     public:
+        // Configuration calls like RegisterSchema or SetEncryptionKeys may run while conversions are in flight. A conversion uses the
+        // configuration from when it started, an async conversion the configuration from when it was queued.
         ParquetWriter();
         ParquetWriter(const unordered_map<string, string>& schemaData);
+        ~ParquetWriter();
 
         // Register schema for schemaKey, will overwrite if current key exists.
         int RegisterSchema(const string& schemaKey, const string& schemaData);
 
+        // Promote repeated paths of schemaKey to child tables keyed by resource id and list ordinals in conversions to output sets, an empty paths clears them.
+        // Paths are reset when the schema of schemaKey is registered again.
+        int SetFlattenedPaths(const string& schemaKey, const vector<string>& paths, char* errorMessage=nullptr);
+
+        // Encrypt parquet outputs of schemaKey with parquet modular encryption while they are encoded, an empty footer key disables encryption.
+        int SetEncryptionKeys(const string& schemaKey, const EncryptionKeys& keys, char* errorMessage=nullptr);
+
+        // Write CRC checksums of data pages, returns PageChecksumNotSupported before arrow 13.
+        int SetPageChecksum(bool enabled, char* errorMessage=nullptr);
+
         // Write input json of resource type to parquet bytes, will try get schema from schema manager.
         int Write(const string& resourceType, const char* inputJson, int inSize, byte** outputData, int* outSize, char* errorMessage=nullptr);
+
+        // Write input json in inputFormat to parquet outputs keyed by schema key. Ndjson and JsonArray inputs produce one output of resourceType,
+        // Bundle and MixedNdjson inputs produce one output per resourceType of their resources and resourceType is not used, resource types
+        // without a registered schema are skipped and listed as skipped keys of outputs.
+        // Flattened paths of a resource type add one output per promoted path after the output of the resource type.
+        int Write(const string& resourceType, InputFormat inputFormat, const char* inputJson, int inSize, ParquetOutputSet* outputs, char* errorMessage=nullptr);
+
+        // Return parquet bytes from Write or WriteAsync to the writer's output buffer pool, other outputs are deleted.
+        // ReleaseOutput and OutputBufferPool::FreeOutput are the only ways to free these outputs, plain delete[] leaves them tracked by the pool.
+        void ReleaseOutput(byte* outputData);
+
+        // Get moving averages of the parquet conversions of schemaKey.
+        int GetStatistics(const string& schemaKey, ConversionStatistics* statistics);
+
+        // Recommend an input batch size for schemaKey that produces about targetOutputBytes of parquet within targetLatencyMilliseconds.
+        int GetRecommendedBatchSize(const string& schemaKey, long long targetOutputBytes, int targetLatencyMilliseconds, long long* inputBytes, long long* rows);
+
+        // Write input json of resource type to arrow IPC file (feather v2) bytes.
+        int WriteArrowIpc(const string& resourceType, const char* inputJson, int inSize, byte** outputData, int* outSize, char* errorMessage=nullptr);
+
+        // Export input json of resource type as an arrow C stream, the consumer owns the stream and must call its release callback.
+        int WriteArrowStream(const string& resourceType, const char* inputJson, int inSize, struct ArrowArrayStream* outputStream, char* errorMessage=nullptr);
+
+        // Set the input size above which Write parses and encodes in a pipeline, the output then has one row group per chunk.
+        int SetPipelineChunkSize(int pipelineChunkSize);
+
+        // Queue conversion of input json on the writer's executor, callback is invoked on an executor thread when the job finishes or is cancelled.
+        // inputJson must stay valid until the callback is invoked. Returns TooManyInFlightConversions without queuing when the in-flight limit is reached.
+        int WriteAsync(const string& resourceType, const char* inputJson, int inSize, ConversionCallback callback, void* state, long long* jobId, char* errorMessage=nullptr);
+
+        // Cancel a queued or running async conversion, a running job stops before the next phase and reports ConversionCancelled.
+        int CancelAsync(long long jobId);
+
+        // Set the maximum number of async conversions that are queued, running or inside their callback.
+        int SetMaxInFlightJobs(int maxInFlightJobs);
+
+        // Compact parquet inputs of schemaKey into outputs of about targetFileSize bytes, will try get schema from schema manager.
+        int Compact(const string& schemaKey, const InputFileFactory& openInput, int inputCount, const OutputStreamFactory& openOutput, int64_t targetFileSize, int* outputCount, char* errorMessage=nullptr);
 };
@@ -1,4 +1,5 @@
 #include "SchemaManager.h"
+#include <arrow/util/config.h>
 
 bool LoadJson(const string& json, Json::Value* root)
 {
@@ -83,6 +84,119 @@ vector<shared_ptr<arrow::Field>> GenerateSchemaFields(const Json::Value& node)
     return result;
 }
 
+// Whether the parquet writer can write a leaf of arrow type with encoding, some encodings were only added in later arrow versions.
+bool IsSupportedEncoding(arrow::Type::type type, parquet::Encoding::type encoding)
+{
+    switch (encoding)
+    {
+        case parquet::Encoding::PLAIN:
+            return true;
+        case parquet::Encoding::DELTA_BINARY_PACKED:
+            return type == arrow::Type::INT32;
+        case parquet::Encoding::BYTE_STREAM_SPLIT:
+            return type == arrow::Type::DOUBLE || (ARROW_VERSION_MAJOR >= 16 && type == arrow::Type::INT32);
+        case parquet::Encoding::DELTA_LENGTH_BYTE_ARRAY:
+            return ARROW_VERSION_MAJOR >= 11 && type == arrow::Type::STRING;
+        case parquet::Encoding::DELTA_BYTE_ARRAY:
+            return ARROW_VERSION_MAJOR >= 12 && type == arrow::Type::STRING;
+        case parquet::Encoding::RLE:
+            return ARROW_VERSION_MAJOR >= 12 && type == arrow::Type::BOOL;
+        default:
+            return false;
+    }
+}
+
+// Encoding of a leaf from the Encoding hint of its node, or from its FHIR type when there is no hint.
+// Return false if the leaf keeps the default dictionary encoding.
+bool GetLeafEncoding(const Json::Value& node, parquet::Encoding::type* encoding)
+{
+    static const unordered_map<string, parquet::Encoding::type> encodingHints
+    {
+        { "PLAIN", parquet::Encoding::PLAIN },
+        { "RLE", parquet::Encoding::RLE },
+        { "DELTA_BINARY_PACKED", parquet::Encoding::DELTA_BINARY_PACKED },
+        { "DELTA_LENGTH_BYTE_ARRAY", parquet::Encoding::DELTA_LENGTH_BYTE_ARRAY },
+        { "DELTA_BYTE_ARRAY", parquet::Encoding::DELTA_BYTE_ARRAY },
+        { "BYTE_STREAM_SPLIT", parquet::Encoding::BYTE_STREAM_SPLIT },
+    };
+
+    const Json::Value hint = node[EncodingHintName];
+    if (!hint.isNull())
+    {
+        if (hint.asString() == DictionaryEncodingHint)
+        {
+            return false;
+        }
+
+        auto itr = encodingHints.find(hint.asString());
+        if (itr == encodingHints.end())
+        {
+            throw invalid_argument("Unknown encoding hint '" + hint.asString() + "'.");
+        }
+
+        // A hint the writer can't apply would fail every conversion, so it fails the schema instead.
+        const auto type = GeneratePrimitiveField(ElementNodeName, node)->type();
+        if (!IsSupportedEncoding(type->id(), itr->second))
+        {
+            throw invalid_argument("Encoding hint '" + hint.asString() + "' is not supported for " + type->ToString() + " leaves.");
+        }
+
+        *encoding = itr->second;
+        return true;
+    }
+
+    // Small integers like counters delta encode well, decimals compress better with their bytes split into streams and booleans
+    // with runs of the same value as RLE, once the arrow version can write it.
+    string dataType = node["Type"].asString();
+    if (FhirIntTypes.find(dataType) != FhirIntTypes.end())
+    {
+        *encoding = parquet::Encoding::DELTA_BINARY_PACKED;
+        return true;
+    }
+    else if (FhirDecimalTypes.find(dataType) != FhirDecimalTypes.end())
+    {
+        *encoding = parquet::Encoding::BYTE_STREAM_SPLIT;
+        return true;
+    }
+    else if (FhirBooleanTypes.find(dataType) != FhirBooleanTypes.end() && IsSupportedEncoding(arrow::Type::BOOL, parquet::Encoding::RLE))
+    {
+        *encoding = parquet::Encoding::RLE;
+        return true;
+    }
+
+    return false;
+}
+
+// Walk the schema the same way as GenerateSchemaFields, list fields add the list and element levels of the parquet column path.
+void GenerateColumnEncodings(const string& pathPrefix, const Json::Value& node, ColumnEncodings* encodings)
+{
+    const Json::Value subNodes = node["SubNodes"];
+    if (subNodes.isNull())
+    {
+        return;
+    }
+
+    for (auto const& fieldName : subNodes.getMemberNames())
+    {
+        const Json::Value subNode = subNodes[fieldName];
+        string path = pathPrefix + fieldName;
+        if (subNode["IsRepeated"].asBool())
+        {
+            path += ".list." + ElementNodeName;
+        }
+
+        parquet::Encoding::type encoding;
+        if (!subNode["IsLeaf"].asBool())
+        {
+            GenerateColumnEncodings(path + ".", subNode, encodings);
+        }
+        else if (GetLeafEncoding(subNode, &encoding))
+        {
+            encodings->push_back(make_pair(path, encoding));
+        }
+    }
+}
+
 // Get schema from schema manager, will return nullptr if schemaKey not present.
 shared_ptr<arrow::Schema> SchemaManager::GetSchema(const string& schemaKey)
 {
@@ -96,6 +210,12 @@ shared_ptr<arrow::Schema> SchemaManager::GetSchema(const string& schemaKey)
     return itr->second;
 }
 
+const ColumnEncodings* SchemaManager::GetColumnEncodings(const string& schemaKey)
+{
+    auto itr = _encodingSet.find(schemaKey);
+    return itr == _encodingSet.end() ? nullptr : &itr->second;
+}
+
 // Add schema to schema manager, will overwrite the schema if schemaKey already presents.
 // Return 0 if operation succeeds.
 int SchemaManager::AddSchema(const string& schemaKey, const string& schemaJson)
@@ -113,7 +233,10 @@ int SchemaManager::AddSchema(const string& schemaKey, const string& schemaJson)
 
     try
     {
+        ColumnEncodings encodings;
+        GenerateColumnEncodings("", root, &encodings);
         _schemaSet[schemaKey] = arrow::schema(GenerateSchemaFields(root));
+        _encodingSet[schemaKey] = move(encodings);
         return 0;
     }
     catch (const std::exception& e)
@@ -1,6 +1,7 @@
 #pragma once
 #include <arrow/api.h>
 #include <json/json.h>
+#include <parquet/types.h>
 #include <iostream>
 #include <set>
 #include <vector>
@@ -12,9 +13,16 @@ const string ElementNodeName = "element";
 const set<string> FhirIntTypes { "positiveInt", "integer", "unsignedInt" };
 const set<string> FhirDecimalTypes { "decimal", "number" };
 const set<string> FhirBooleanTypes { "boolean" };
+const string EncodingHintName = "Encoding";
+// Encoding hint that keeps the default dictionary encoding of a leaf.
+const string DictionaryEncodingHint = "DICTIONARY";
+
+// Parquet column path of a leaf field and the encoding recommended for it.
+typedef vector<pair<string, parquet::Encoding::type>> ColumnEncodings;
 
 shared_ptr<arrow::Field> GenerateStructField(const string& fieldName, const Json::Value& node);
 vector<shared_ptr<arrow::Field>> GenerateSchemaFields(const Json::Value& node);
+void GenerateColumnEncodings(const string& pathPrefix, const Json::Value& node, ColumnEncodings* encodings);
 bool LoadJson(const string& json, Json::Value* root);
 bool IsEmptyOrWhitespace(const std::string& str);
 
@@ -22,10 +30,14 @@ class SchemaManager
 {
     private:
         unordered_map<string, shared_ptr<arrow::Schema>> _schemaSet;
+        unordered_map<string, ColumnEncodings> _encodingSet;
     
     public:
 
         int AddSchema(const string& schemaKey, const string& schemaJson);
 
         shared_ptr<arrow::Schema> GetSchema(const string& schemaKey);
+
+        // Get the recommended encodings of the leaf columns of schemaKey, will return nullptr if schemaKey not present.
+        const ColumnEncodings* GetColumnEncodings(const string& schemaKey);
 };
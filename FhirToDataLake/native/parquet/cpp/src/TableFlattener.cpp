@@ -0,0 +1,381 @@
+#include "TableFlattener.h"
+#include <algorithm>
+#include <arrow/array/concatenate.h>
+#include <cctype>
+#include <sstream>
+
+static vector<string> SplitPath(const string& path)
+{
+    vector<string> segments;
+    stringstream pathStream(path);
+    string segment;
+    while (getline(pathStream, segment, '.'))
+    {
+        segments.push_back(segment);
+    }
+
+    return segments;
+}
+
+// Element type below any list levels of type.
+static shared_ptr<arrow::DataType> GetElementType(shared_ptr<arrow::DataType> type, bool* isRepeated)
+{
+    while (type->id() == arrow::Type::LIST)
+    {
+        *isRepeated = true;
+        type = static_cast<const arrow::ListType&>(*type).value_type();
+    }
+
+    return type;
+}
+
+bool ValidateFlattenedPaths(const arrow::Schema& schema, const vector<string>& paths, string* error)
+{
+    const auto idField = schema.GetFieldByName(ResourceIdFieldName);
+    if (idField == nullptr || idField->type()->id() != arrow::Type::STRING)
+    {
+        *error = "Schema has no string '" + ResourceIdFieldName + "' field to key child tables.";
+        return false;
+    }
+
+    for (const auto& path : paths)
+    {
+        const vector<string> segments = SplitPath(path);
+        bool isRepeated = false;
+        shared_ptr<arrow::DataType> type;
+        shared_ptr<arrow::DataType> parentType;
+        for (size_t i = 0; i < segments.size(); i++)
+        {
+            parentType = type;
+            const auto field = i == 0 ? schema.GetFieldByName(segments[i]) : type->id() == arrow::Type::STRUCT ? static_cast<const arrow::StructType&>(*type).GetFieldByName(segments[i]) : nullptr;
+            if (field == nullptr)
+            {
+                *error = "Flattened path '" + path + "' not found in schema.";
+                return false;
+            }
+
+            type = GetElementType(field->type(), &isRepeated);
+        }
+
+        if (!isRepeated)
+        {
+            *error = "Flattened path '" + path + "' is not repeated.";
+            return false;
+        }
+
+        for (const auto& other : paths)
+        {
+            if (&other != &path && (other == path || path.compare(0, other.size() + 1, other + ".") == 0))
+            {
+                *error = "Flattened path '" + path + "' overlaps with '" + other + "'.";
+                return false;
+            }
+        }
+
+        // Parquet can't write a struct without fields, so the paths must leave at least one field of each parent struct.
+        if (parentType != nullptr)
+        {
+            const string parentPrefix = path.substr(0, path.rfind('.') + 1);
+            const auto removedCount = count_if(paths.begin(), paths.end(), [&parentPrefix](const string& other)
+            {
+                return other.compare(0, parentPrefix.size(), parentPrefix) == 0 && other.find('.', parentPrefix.size()) == string::npos;
+            });
+            if (removedCount >= parentType->num_fields())
+            {
+                *error = "Flattened paths remove every field of '" + path.substr(0, parentPrefix.size() - 1) + "'.";
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+string GetOrdinalColumnName(const string& segment, int level)
+{
+    return segment + "_index" + (level == 0 ? "" : to_string(level + 1));
+}
+
+bool IsChildKeyColumn(const string& path, const string& columnName)
+{
+    if (columnName == ResourceIdColumnName)
+    {
+        return true;
+    }
+
+    for (const auto& segment : SplitPath(path))
+    {
+        const string prefix = segment + "_index";
+        if (columnName.compare(0, prefix.size(), prefix) == 0 && all_of(columnName.begin() + prefix.size(), columnName.end(), ::isdigit))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+string GetFlattenedTableName(const string& schemaKey, const string& path)
+{
+    string tableName = schemaKey + "_" + path;
+    replace(tableName.begin(), tableName.end(), '.', '_');
+    return tableName;
+}
+
+// Replace list values by their elements, rows maps every element to the root row it belongs to.
+// Ordinals holds the position of every element in each expanded list level, the level expanded here is appended.
+static arrow::Status ExpandList(shared_ptr<arrow::Array>* array, vector<int64_t>* rows, vector<vector<int32_t>>* ordinals)
+{
+    const auto& listArray = static_cast<const arrow::ListArray&>(**array);
+    vector<int64_t> elementRows;
+    vector<vector<int32_t>> elementOrdinals(ordinals->size() + 1);
+    arrow::ArrayVector slices;
+    int64_t rangeStart = 0;
+    int64_t rangeEnd = 0;
+    for (int64_t i = 0; i < listArray.length(); i++)
+    {
+        if (listArray.IsNull(i) || listArray.value_length(i) == 0)
+        {
+            continue;
+        }
+
+        // Elements of consecutive lists are usually adjacent, so they are sliced as one range.
+        if (listArray.value_offset(i) != rangeEnd)
+        {
+            if (rangeEnd > rangeStart)
+            {
+                slices.push_back(listArray.values()->Slice(rangeStart, rangeEnd - rangeStart));
+            }
+
+            rangeStart = listArray.value_offset(i);
+        }
+
+        rangeEnd = listArray.value_offset(i + 1);
+        elementRows.insert(elementRows.end(), listArray.value_length(i), (*rows)[i]);
+        for (size_t level = 0; level < ordinals->size(); level++)
+        {
+            elementOrdinals[level].insert(elementOrdinals[level].end(), listArray.value_length(i), (*ordinals)[level][i]);
+        }
+
+        for (int32_t j = 0; j < listArray.value_length(i); j++)
+        {
+            elementOrdinals.back().push_back(j);
+        }
+    }
+
+    if (rangeEnd > rangeStart || slices.empty())
+    {
+        slices.push_back(listArray.values()->Slice(rangeStart, rangeEnd - rangeStart));
+    }
+
+    if (slices.size() == 1)
+    {
+        *array = slices[0];
+    }
+    else
+    {
+        ARROW_ASSIGN_OR_RAISE(*array, arrow::Concatenate(slices));
+    }
+
+    *rows = move(elementRows);
+    *ordinals = move(elementOrdinals);
+    return arrow::Status::OK();
+}
+
+// Follow segments from a column chunk of the root table to the values of the promoted path.
+static arrow::Status ExtractPath(shared_ptr<arrow::Array> array, const vector<string>& segments, shared_ptr<arrow::Array>* values, vector<int64_t>* rows, vector<vector<int32_t>>* ordinals)
+{
+    rows->resize(array->length());
+    for (int64_t i = 0; i < array->length(); i++)
+    {
+        (*rows)[i] = i;
+    }
+
+    for (size_t i = 0; i < segments.size(); i++)
+    {
+        if (i > 0)
+        {
+            const auto& structArray = static_cast<const arrow::StructArray&>(*array);
+            ARROW_ASSIGN_OR_RAISE(array, structArray.GetFlattenedField(structArray.struct_type()->GetFieldIndex(segments[i])));
+        }
+
+        while (array->type_id() == arrow::Type::LIST)
+        {
+            ARROW_RETURN_NOT_OK(ExpandList(&array, rows, ordinals));
+        }
+    }
+
+    *values = array;
+    return arrow::Status::OK();
+}
+
+static shared_ptr<arrow::DataType> RemovePathFromType(const shared_ptr<arrow::DataType>& type, const vector<string>& segments, size_t segmentIndex)
+{
+    if (type->id() == arrow::Type::LIST)
+    {
+        const auto& listType = static_cast<const arrow::ListType&>(*type);
+        return arrow::list(listType.value_field()->WithType(RemovePathFromType(listType.value_type(), segments, segmentIndex)));
+    }
+
+    auto fields = type->fields();
+    const int fieldIndex = static_cast<const arrow::StructType&>(*type).GetFieldIndex(segments[segmentIndex]);
+    if (segmentIndex + 1 == segments.size())
+    {
+        fields.erase(fields.begin() + fieldIndex);
+    }
+    else
+    {
+        fields[fieldIndex] = fields[fieldIndex]->WithType(RemovePathFromType(fields[fieldIndex]->type(), segments, segmentIndex + 1));
+    }
+
+    return arrow::struct_(fields);
+}
+
+// Rebuild the array data without the promoted field, buffers and offsets of all other levels are shared.
+static shared_ptr<arrow::ArrayData> RemovePathFromData(const shared_ptr<arrow::ArrayData>& data, const vector<string>& segments, size_t segmentIndex)
+{
+    auto result = data->Copy();
+    result->type = RemovePathFromType(data->type, segments, segmentIndex);
+    if (data->type->id() == arrow::Type::LIST)
+    {
+        result->child_data[0] = RemovePathFromData(data->child_data[0], segments, segmentIndex);
+        return result;
+    }
+
+    const int fieldIndex = static_cast<const arrow::StructType&>(*data->type).GetFieldIndex(segments[segmentIndex]);
+    if (segmentIndex + 1 == segments.size())
+    {
+        result->child_data.erase(result->child_data.begin() + fieldIndex);
+    }
+    else
+    {
+        result->child_data[fieldIndex] = RemovePathFromData(data->child_data[fieldIndex], segments, segmentIndex + 1);
+    }
+
+    return result;
+}
+
+static arrow::Status BuildChildTable(const shared_ptr<arrow::Table>& table, const vector<string>& segments, shared_ptr<arrow::Table>* childTable)
+{
+    // Record batches of the table have aligned id and path chunks.
+    arrow::TableBatchReader batchReader(*table);
+    shared_ptr<arrow::RecordBatch> batch;
+    arrow::ArrayVector resourceIds;
+    vector<arrow::ArrayVector> columns;
+    shared_ptr<arrow::Array> values;
+    ARROW_RETURN_NOT_OK(batchReader.ReadNext(&batch));
+    while (batch != nullptr)
+    {
+        vector<int64_t> rows;
+        vector<vector<int32_t>> ordinals;
+        ARROW_RETURN_NOT_OK(ExtractPath(batch->GetColumnByName(segments[0]), segments, &values, &rows, &ordinals));
+
+        const auto& ids = static_cast<const arrow::StringArray&>(*batch->GetColumnByName(ResourceIdFieldName));
+        arrow::StringBuilder idBuilder;
+        ARROW_RETURN_NOT_OK(idBuilder.Reserve(static_cast<int64_t>(rows.size())));
+        for (int64_t row : rows)
+        {
+            ARROW_RETURN_NOT_OK(ids.IsNull(row) ? idBuilder.AppendNull() : idBuilder.Append(ids.GetView(row)));
+        }
+
+        ARROW_ASSIGN_OR_RAISE(auto resourceIdArray, idBuilder.Finish());
+        resourceIds.push_back(resourceIdArray);
+
+        arrow::ArrayVector chunkColumns;
+        for (const auto& levelOrdinals : ordinals)
+        {
+            arrow::Int32Builder ordinalBuilder;
+            ARROW_RETURN_NOT_OK(ordinalBuilder.AppendValues(levelOrdinals));
+            ARROW_ASSIGN_OR_RAISE(auto ordinalArray, ordinalBuilder.Finish());
+            chunkColumns.push_back(ordinalArray);
+        }
+
+        if (values->type_id() == arrow::Type::STRUCT)
+        {
+            ARROW_ASSIGN_OR_RAISE(auto fieldColumns, static_cast<const arrow::StructArray&>(*values).Flatten());
+            chunkColumns.insert(chunkColumns.end(), fieldColumns.begin(), fieldColumns.end());
+        }
+        else
+        {
+            chunkColumns.push_back(values);
+        }
+
+        columns.resize(chunkColumns.size());
+        for (size_t i = 0; i < chunkColumns.size(); i++)
+        {
+            columns[i].push_back(chunkColumns[i]);
+        }
+
+        ARROW_RETURN_NOT_OK(batchReader.ReadNext(&batch));
+    }
+
+    // One ordinal column for each list level expanded on the way to the values, named after the segment holding the list.
+    arrow::FieldVector fields { arrow::field(ResourceIdColumnName, arrow::utf8()) };
+    shared_ptr<arrow::DataType> valueType = table->schema()->GetFieldByName(segments[0])->type();
+    for (size_t i = 0; i < segments.size(); i++)
+    {
+        if (i > 0)
+        {
+            valueType = static_cast<const arrow::StructType&>(*valueType).GetFieldByName(segments[i])->type();
+        }
+
+        for (int level = 0; valueType->id() == arrow::Type::LIST; level++)
+        {
+            fields.push_back(arrow::field(GetOrdinalColumnName(segments[i], level), arrow::int32(), false));
+            valueType = static_cast<const arrow::ListType&>(*valueType).value_type();
+        }
+    }
+
+    if (valueType->id() == arrow::Type::STRUCT)
+    {
+        fields.insert(fields.end(), valueType->fields().begin(), valueType->fields().end());
+    }
+    else
+    {
+        fields.push_back(arrow::field(segments.back(), valueType));
+    }
+
+    vector<shared_ptr<arrow::ChunkedArray>> chunkedColumns { make_shared<arrow::ChunkedArray>(resourceIds, arrow::utf8()) };
+    columns.resize(fields.size() - 1);
+    for (size_t i = 0; i < columns.size(); i++)
+    {
+        chunkedColumns.push_back(make_shared<arrow::ChunkedArray>(columns[i], fields[i + 1]->type()));
+    }
+
+    *childTable = arrow::Table::Make(arrow::schema(fields), chunkedColumns);
+    return arrow::Status::OK();
+}
+
+arrow::Status FlattenTable(const shared_ptr<arrow::Table>& table, const vector<string>& paths, shared_ptr<arrow::Table>* parentTable, vector<shared_ptr<arrow::Table>>* childTables)
+{
+    // Child tables are built from the original table, so removing one path never affects the extraction of another.
+    shared_ptr<arrow::Table> result = table;
+    for (const auto& path : paths)
+    {
+        const vector<string> segments = SplitPath(path);
+        shared_ptr<arrow::Table> childTable;
+        ARROW_RETURN_NOT_OK(BuildChildTable(table, segments, &childTable));
+        childTables->push_back(childTable);
+
+        const int columnIndex = result->schema()->GetFieldIndex(segments[0]);
+        if (segments.size() == 1)
+        {
+            ARROW_ASSIGN_OR_RAISE(result, result->RemoveColumn(columnIndex));
+            continue;
+        }
+
+        const auto column = result->column(columnIndex);
+        arrow::ArrayVector chunks;
+        for (const auto& chunk : column->chunks())
+        {
+            chunks.push_back(arrow::MakeArray(RemovePathFromData(chunk->data(), segments, 1)));
+        }
+
+        const auto field = result->schema()->field(columnIndex);
+        const auto newType = RemovePathFromType(field->type(), segments, 1);
+        ARROW_ASSIGN_OR_RAISE(result, result->SetColumn(columnIndex, field->WithType(newType), make_shared<arrow::ChunkedArray>(chunks, newType)));
+    }
+
+    *parentTable = result;
+    return arrow::Status::OK();
+}
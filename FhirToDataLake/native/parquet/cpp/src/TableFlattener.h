@@ -0,0 +1,28 @@
+#pragma once
+#include <arrow/api.h>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Column of the child tables holding the id of the resource each row was promoted from.
+const string ResourceIdColumnName = "resourceId";
+const string ResourceIdFieldName = "id";
+
+// Check that the dot separated paths can be promoted from schema: each path names a field that is repeated itself or below a repeated field,
+// no path contains another one and every struct keeps at least one field. Return false with error set otherwise.
+bool ValidateFlattenedPaths(const arrow::Schema& schema, const vector<string>& paths, string* error);
+
+// Name of the ordinal column of the list at level of segment in a child table: name_index for the list of name, given_index for the list of given.
+string GetOrdinalColumnName(const string& segment, int level);
+
+// Whether columnName is the resourceId or an ordinal column of the child table of path, the columns that rejoin it to its parent.
+bool IsChildKeyColumn(const string& path, const string& columnName);
+
+// Name of the child table of a promoted path, e.g. Observation_component_code_coding.
+string GetFlattenedTableName(const string& schemaKey, const string& path);
+
+// Move the values of each promoted path of table into a child table with a resourceId column, the promoted fields are removed from parentTable.
+// The resourceId is followed by one ordinal column per list level on the path, the position of the row's element in that list,
+// so a row of Patient_name_given rejoins name[name_index].given[given_index] of its resource. A promoted struct element is split into one column per struct field.
+arrow::Status FlattenTable(const shared_ptr<arrow::Table>& table, const vector<string>& paths, shared_ptr<arrow::Table>* parentTable, vector<shared_ptr<arrow::Table>>* childTables);
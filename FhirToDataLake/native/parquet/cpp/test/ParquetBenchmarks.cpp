@@ -0,0 +1,140 @@
+#include <arrow/api.h>
+#include <arrow/c/bridge.h>
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include "ParquetTestUtilities.h"
+#include "ParquetWriter.h"
+
+using namespace std;
+
+shared_ptr<arrow::Table> ParseWideResources(ParquetWriter& writer, const string& resources)
+{
+    struct ArrowArrayStream stream;
+    char error[256] = "";
+    if (writer.WriteArrowStream(WideResourceType, resources.c_str(), static_cast<int>(resources.size()), &stream, error) != 0)
+    {
+        cerr << "Failed to parse benchmark input: " << error << endl;
+        return nullptr;
+    }
+
+    const auto reader = arrow::ImportRecordBatchReader(&stream).ValueOrDie();
+    return arrow::Table::FromRecordBatchReader(reader.get()).ValueOrDie();
+}
+
+// Best of a few runs of WriteToParquet in milliseconds.
+double MeasureWriteToParquet(const shared_ptr<arrow::Table>& table, const shared_ptr<parquet::WriterProperties>& writeProperties, const shared_ptr<parquet::ArrowWriterProperties>& arrowWriteProperties, int* outputLength)
+{
+    OutputBufferPool outputBufferPool;
+    double best = 0;
+    for (int iteration = 0; iteration < 3; iteration++)
+    {
+        byte* outputData = nullptr;
+        char error[256] = "";
+        const auto start = chrono::steady_clock::now();
+        if (WriteToParquet(table, &outputData, outputLength, error, writeProperties, arrowWriteProperties, &outputBufferPool) != 0)
+        {
+            cerr << "Failed to write parquet: " << error << endl;
+            return -1;
+        }
+
+        const double elapsed = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        best = iteration == 0 ? elapsed : min(best, elapsed);
+        outputBufferPool.ReleaseOutput(outputData);
+    }
+
+    return best;
+}
+
+// Usage: ParquetBenchmarks [rowCount] [structCount] [leafCount]
+int main(int argc, char** argv)
+{
+    const int rowCount = argc > 1 ? atoi(argv[1]) : 20000;
+    const int structCount = argc > 2 ? atoi(argv[2]) : 50;
+    const int leafCount = argc > 3 ? atoi(argv[3]) : 8;
+
+    ParquetWriter writer;
+    SchemaManager schemaManager;
+    const string wideSchema = generate_wide_schema(structCount, leafCount);
+    if (writer.RegisterSchema(WideResourceType, wideSchema) != 0 || schemaManager.AddSchema(WideResourceType, wideSchema) != 0)
+    {
+        cerr << "Failed to register benchmark schema." << endl;
+        return 1;
+    }
+
+    const auto table = ParseWideResources(writer, generate_wide_resources(rowCount, structCount, leafCount));
+    if (table == nullptr)
+    {
+        return 1;
+    }
+
+    const auto writeProperties = BuildWriteProperties(nullptr);
+    const auto serialProperties = parquet::ArrowWriterProperties::Builder().set_use_threads(false)->build();
+    const auto parallelProperties = parquet::ArrowWriterProperties::Builder().set_use_threads(true)->build();
+
+    cout << "Parallel column chunk encoding, " << rowCount << " rows x " << structCount * leafCount << " leaf columns" << endl;
+    cout << "threads\tserial ms\tparallel ms\tspeedup" << endl;
+    const int maxThreads = max(1, static_cast<int>(thread::hardware_concurrency()));
+    for (int threads = 1; threads <= maxThreads; threads *= 2)
+    {
+        if (!arrow::SetCpuThreadPoolCapacity(threads).ok())
+        {
+            return 1;
+        }
+
+        int outputLength = 0;
+        const double serial = MeasureWriteToParquet(table, writeProperties, serialProperties, &outputLength);
+        const double parallel = MeasureWriteToParquet(table, writeProperties, parallelProperties, &outputLength);
+        if (serial < 0 || parallel < 0)
+        {
+            return 1;
+        }
+
+        cout << threads << "\t" << serial << "\t" << parallel << "\t" << serial / parallel << endl;
+    }
+
+    // Default encodings against the column encodings recommended by the schema, on the full thread pool.
+    if (!arrow::SetCpuThreadPoolCapacity(maxThreads).ok())
+    {
+        return 1;
+    }
+
+    int defaultLength = 0;
+    int schemaLength = 0;
+    const double defaultEncoding = MeasureWriteToParquet(table, writeProperties, parallelProperties, &defaultLength);
+    const double schemaEncoding = MeasureWriteToParquet(table, BuildWriteProperties(schemaManager.GetColumnEncodings(WideResourceType)), parallelProperties, &schemaLength);
+    if (defaultEncoding < 0 || schemaEncoding < 0)
+    {
+        return 1;
+    }
+
+    cout << endl << "Column encodings, " << schemaManager.GetColumnEncodings(WideResourceType)->size() << " columns with a recommended encoding" << endl;
+    cout << "encodings\tms\tbytes" << endl;
+    cout << "default\t" << defaultEncoding << "\t" << defaultLength << endl;
+    cout << "schema\t" << schemaEncoding << "\t" << schemaLength << endl;
+
+    // Steady-state conversions through one writer, every output is returned to the writer's buffer pool.
+    const int conversionCount = 100;
+    const string resources = generate_wide_resources(max(1, rowCount / 10), structCount, leafCount);
+    OutputBufferPool outputBufferPool;
+    for (int i = 0; i < conversionCount; i++)
+    {
+        byte* outputData = nullptr;
+        int outputLength = 0;
+        char error[256] = "";
+        if (WriteToParquet(ParseWideResources(writer, resources), &outputData, &outputLength, error, writeProperties, parallelProperties, &outputBufferPool) != 0)
+        {
+            cerr << "Failed to write parquet: " << error << endl;
+            return 1;
+        }
+
+        outputBufferPool.ReleaseOutput(outputData);
+    }
+
+    cout << endl << "Output buffer pool, " << conversionCount << " conversions" << endl;
+    cout << "allocations\treuses" << endl;
+    cout << outputBufferPool.AllocationCount() << "\t" << outputBufferPool.ReuseCount() << endl;
+
+    return 0;
+}
@@ -0,0 +1,241 @@
+#include "ParquetTestUtilities.h"
+#include "ParquetWriter.h"
+#include <functional>
+#include <future>
+#include <random>
+using namespace std;
+
+// A conversion path under test, returns the converted table or nullptr with error set.
+typedef function<shared_ptr<arrow::Table>(ParquetWriter& writer, const vector<string>& resources, string* error)> ConversionPath;
+
+static const vector<string> RandomNames { "Chalmers", "Windsor", "O'Brien", "Zoë", "Nguyễn", "李", "quote\\\"d", "back\\\\slash", "new\\nline", "\\u00e9t\\u00e9", "" };
+
+static string RandomString(mt19937& random)
+{
+    return "\"" + RandomNames[random() % RandomNames.size()] + "\"";
+}
+
+// Random member separator whitespace, valid anywhere between json tokens of a single line.
+static string RandomSpace(mt19937& random)
+{
+    static const vector<string> spaces { "", "", " ", "\t", "  " };
+    return spaces[random() % spaces.size()];
+}
+
+// Join members in random order, members set to null or left out are also valid for the schema.
+static string RandomObject(mt19937& random, vector<pair<string, string>> members)
+{
+    shuffle(members.begin(), members.end(), random);
+    string result = "{";
+    for (const auto& member : members)
+    {
+        const int presence = random() % 8;
+        if (presence == 0)
+        {
+            continue;
+        }
+
+        result += (result.size() > 1 ? "," : "") + RandomSpace(random) + "\"" + member.first + "\":" + RandomSpace(random) + (presence == 1 ? "null" : member.second);
+    }
+
+    return result + "}";
+}
+
+static string RandomList(mt19937& random, const function<string()>& element)
+{
+    const int count = random() % 4;
+    string result = "[";
+    for (int i = 0; i < count; i++)
+    {
+        result += (i == 0 ? "" : ",") + element();
+    }
+
+    return result + "]";
+}
+
+// Patients conforming to patient_example_schema.json, with unknown members that the writer ignores.
+static vector<string> GenerateRandomPatients(mt19937& random, int count)
+{
+    vector<string> patients;
+    for (int i = 0; i < count; i++)
+    {
+        const string name = RandomList(random, [&]()
+        {
+            return RandomObject(random, {
+                { "use", random() % 2 == 0 ? "\"official\"" : "\"usual\"" },
+                { "family", RandomString(random) },
+                { "given", RandomList(random, [&]() { return RandomString(random); }) },
+            });
+        });
+
+        string patient = RandomObject(random, {
+            { "id", "\"" + to_string(i) + "\"" },
+            { "gender", random() % 2 == 0 ? "\"male\"" : "\"female\"" },
+            { "birthDate", "\"19" + to_string(10 + random() % 90) + "-0" + to_string(1 + random() % 9) + "-1" + to_string(random() % 10) + "\"" },
+            { "deceasedBoolean", random() % 2 == 0 ? "true" : "false" },
+            { "managingOrganization", RandomObject(random, { { "reference", "\"Organization/" + to_string(random() % 100) + "\"" } }) },
+            { "name", name },
+            { "extension", "[{\"url\":\"http://example.org\",\"valueInteger\":" + to_string(random() % 1000) + "}]" },
+        });
+
+        // Every resource carries its resourceType so the routed input formats see each line.
+        patients.push_back("{\"resourceType\":\"Patient\"," + patient.substr(1));
+        if (patients.back() == "{\"resourceType\":\"Patient\",}")
+        {
+            patients.back() = "{\"resourceType\":\"Patient\"}";
+        }
+    }
+
+    return patients;
+}
+
+static string JoinResources(const vector<string>& resources, const string& prefix, const string& separator, const string& suffix)
+{
+    string result = prefix;
+    for (size_t i = 0; i < resources.size(); i++)
+    {
+        result += (i == 0 ? "" : separator) + resources[i];
+    }
+
+    return result + suffix;
+}
+
+static shared_ptr<arrow::Table> ParseOutput(byte* outputData, int outputLength)
+{
+    return parse_buffer_to_table(arrow::Buffer::FromString(string(reinterpret_cast<char*>(outputData), outputLength)));
+}
+
+static shared_ptr<arrow::Table> ConvertToOutputSet(ParquetWriter& writer, InputFormat inputFormat, const string& input, string* error)
+{
+    ParquetOutputSet outputs;
+    char errorMessage[256] = "";
+    if (writer.Write("Patient", inputFormat, input.c_str(), static_cast<int>(input.size()), &outputs, errorMessage) != 0 || outputs.Count() != 1)
+    {
+        *error = errorMessage;
+        return nullptr;
+    }
+
+    const string* key;
+    shared_ptr<arrow::Buffer> buffer;
+    outputs.Get(0, &key, &buffer);
+    return parse_buffer_to_table(buffer);
+}
+
+static shared_ptr<arrow::Table> ConvertDefault(ParquetWriter& writer, const vector<string>& resources, string* error)
+{
+    const string input = JoinResources(resources, "", "\n", "\n");
+    byte* outputData = nullptr;
+    int outputLength = 0;
+    char errorMessage[256] = "";
+    if (writer.Write("Patient", input.c_str(), static_cast<int>(input.size()), &outputData, &outputLength, errorMessage) != 0)
+    {
+        *error = errorMessage;
+        return nullptr;
+    }
+
+    const auto table = ParseOutput(outputData, outputLength);
+    writer.ReleaseOutput(outputData);
+    return table;
+}
+
+struct DifferentialConversionState
+{
+    ParquetWriter* writer;
+    promise<pair<int, string>> result;
+};
+
+static void CompleteDifferentialConversion(long long jobId, int status, byte* outputData, int outputLength, const char* errorMessage, void* state)
+{
+    auto conversionState = static_cast<DifferentialConversionState*>(state);
+    const string output = status == 0 ? string(reinterpret_cast<char*>(outputData), outputLength) : string(errorMessage);
+    conversionState->writer->ReleaseOutput(outputData);
+    conversionState->result.set_value(make_pair(status, output));
+}
+
+// Alternative paths that must produce the same table as ConvertDefault, new fast paths are added here.
+static const vector<pair<string, ConversionPath>> ConversionPaths
+{
+    { "pipelined", [](ParquetWriter& writer, const vector<string>& resources, string* error)
+    {
+        ParquetWriter pipelinedWriter;
+        pipelinedWriter.RegisterSchema("Patient", read_file_text(TestDataDir + "patient_example_schema.json"));
+        pipelinedWriter.SetPipelineChunkSize(256);
+        return ConvertDefault(pipelinedWriter, resources, error);
+    } },
+    { "async", [](ParquetWriter& writer, const vector<string>& resources, string* error) -> shared_ptr<arrow::Table>
+    {
+        const string input = JoinResources(resources, "", "\n", "\n");
+        DifferentialConversionState state;
+        state.writer = &writer;
+        long long jobId = 0;
+        char errorMessage[256] = "";
+        if (writer.WriteAsync("Patient", input.c_str(), static_cast<int>(input.size()), CompleteDifferentialConversion, &state, &jobId, errorMessage) != 0)
+        {
+            *error = errorMessage;
+            return nullptr;
+        }
+
+        const auto output = state.result.get_future().get();
+        if (output.first != 0)
+        {
+            *error = output.second;
+            return nullptr;
+        }
+
+        return parse_buffer_to_table(arrow::Buffer::FromString(output.second));
+    } },
+    { "arrow stream", [](ParquetWriter& writer, const vector<string>& resources, string* error) -> shared_ptr<arrow::Table>
+    {
+        const string input = JoinResources(resources, "", "\n", "\n");
+        struct ArrowArrayStream stream;
+        char errorMessage[256] = "";
+        if (writer.WriteArrowStream("Patient", input.c_str(), static_cast<int>(input.size()), &stream, errorMessage) != 0)
+        {
+            *error = errorMessage;
+            return nullptr;
+        }
+
+        const auto reader = arrow::ImportRecordBatchReader(&stream).ValueOrDie();
+        return arrow::Table::FromRecordBatchReader(reader.get()).ValueOrDie();
+    } },
+    { "ndjson output set", [](ParquetWriter& writer, const vector<string>& resources, string* error)
+    {
+        return ConvertToOutputSet(writer, Ndjson, JoinResources(resources, "", "\n", "\n"), error);
+    } },
+    { "json array", [](ParquetWriter& writer, const vector<string>& resources, string* error)
+    {
+        return ConvertToOutputSet(writer, JsonArray, JoinResources(resources, "[\n", ",\n", "\n]"), error);
+    } },
+    { "bundle", [](ParquetWriter& writer, const vector<string>& resources, string* error)
+    {
+        return ConvertToOutputSet(writer, Bundle, JoinResources(resources, "{\"resourceType\":\"Bundle\",\"entry\":[{\"resource\":", "},\n{\"resource\":", "}]}"), error);
+    } },
+    { "mixed ndjson", [](ParquetWriter& writer, const vector<string>& resources, string* error)
+    {
+        return ConvertToOutputSet(writer, MixedNdjson, JoinResources(resources, "", "\n", "\n"), error);
+    } },
+};
+
+TEST (ParquetDifferential, RandomPatientsMatchAcrossConversionPaths)
+{
+    ParquetWriter writer;
+    int schemaStatus = writer.RegisterSchema("Patient", read_file_text(TestDataDir + "patient_example_schema.json"));
+    EXPECT_EQ(0, schemaStatus);
+
+    for (unsigned int seed = 1; seed <= 20; seed++)
+    {
+        mt19937 random(seed);
+        const vector<string> resources = GenerateRandomPatients(random, 1 + random() % 50);
+        string error;
+        const auto expected_table = ConvertDefault(writer, resources, &error);
+        ASSERT_NE(nullptr, expected_table) << "seed " << seed << ": " << error;
+        EXPECT_EQ(static_cast<int64_t>(resources.size()), expected_table->num_rows());
+
+        for (const auto& conversionPath : ConversionPaths)
+        {
+            const auto table = conversionPath.second(writer, resources, &error);
+            ASSERT_NE(nullptr, table) << conversionPath.first << ", seed " << seed << ": " << error;
+            EXPECT_TRUE(expected_table->Equals(*table)) << conversionPath.first << ", seed " << seed;
+        }
+    }
+}
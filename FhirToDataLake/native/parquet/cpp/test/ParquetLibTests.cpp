@@ -110,3 +110,148 @@ TEST (ParquetLib, WriteExamplePatient)
     TryReleaseUnmanagedData(outputData);
     EXPECT_EQ(nullptr, *outputData);
 }
+
+TEST (ParquetLib, WriteExamplePatientToArrowStream)
+{
+    ParquetWriter* writer = CreateParquetWriter();
+
+    string resourceType = "Patient";
+    string exampleSchema = read_file_text(TestDataDir + "patient_example_schema.json");
+    int schemaStatus = RegisterParquetSchema(writer, resourceType.data(), exampleSchema.data());
+    EXPECT_EQ(0, schemaStatus);
+
+    struct ArrowArrayStream stream;
+    char* error = new char[256];
+    int status = ConvertJsonToArrowStream(writer, resourceType.c_str(), PatientData.c_str(), PatientData.size(), &stream, error);
+    // Write success.
+    EXPECT_EQ(0, status);
+
+    const auto reader = arrow::ImportRecordBatchReader(&stream).ValueOrDie();
+    const auto table = arrow::Table::FromRecordBatchReader(reader.get()).ValueOrDie();
+    const auto expected_table = get_expected_patient_table();
+    EXPECT_TRUE(expected_table->Equals(*table));
+
+    DestroyParquetWriter(writer);
+    delete[] error;
+}
+
+TEST (ParquetLib, CompactExamplePatientBuffers)
+{
+    ParquetWriter* writer = CreateParquetWriter();
+
+    string resourceType = "Patient";
+    string exampleSchema = read_file_text(TestDataDir + "patient_example_schema.json");
+    int schemaStatus = RegisterParquetSchema(writer, resourceType.data(), exampleSchema.data());
+    EXPECT_EQ(0, schemaStatus);
+
+    byte* inputData[2];
+    int inputLengths[2];
+    char* error = new char[256];
+    for (int i = 0; i < 2; i++)
+    {
+        int status = ConvertJsonToParquet(writer, resourceType.c_str(), PatientData.c_str(), PatientData.size(), &inputData[i], &inputLengths[i], error);
+        EXPECT_EQ(0, status);
+    }
+
+    ParquetOutputSet* outputs = nullptr;
+    int status = CompactParquetBuffers(writer, resourceType.c_str(), const_cast<const byte**>(inputData), inputLengths, 2, 0, &outputs, error);
+    EXPECT_EQ(0, status);
+    EXPECT_EQ(1, GetParquetOutputCount(outputs));
+
+    const char* outputKey = nullptr;
+    const byte* outputData = nullptr;
+    int outputLength = 0;
+    status = GetParquetOutput(outputs, 0, &outputKey, &outputData, &outputLength);
+    EXPECT_EQ(0, status);
+    EXPECT_EQ(resourceType, string(outputKey));
+
+    const auto buffer = std::make_shared<arrow::Buffer>(outputData, outputLength);
+    const std::shared_ptr<arrow::Table> table = parse_buffer_to_table(buffer);
+    check_table_fields_columns(table, get_patient_schema(), 2);
+
+    EXPECT_NE(0, GetParquetOutput(outputs, 1, &outputKey, &outputData, &outputLength));
+
+    DestroyParquetOutputSet(outputs);
+    TryReleaseUnmanagedData(&inputData[0]);
+    TryReleaseUnmanagedData(&inputData[1]);
+    DestroyParquetWriter(writer);
+    delete[] error;
+}
+
+TEST (ParquetLib, ConvertExamplePatientBundle)
+{
+    ParquetWriter* writer = CreateParquetWriter();
+
+    string resourceType = "Patient";
+    string exampleSchema = read_file_text(TestDataDir + "patient_example_schema.json");
+    int schemaStatus = RegisterParquetSchema(writer, resourceType.data(), exampleSchema.data());
+    EXPECT_EQ(0, schemaStatus);
+
+    string bundleData = R"({"resourceType":"Bundle","entry":[{"resource":)" + PatientData + "},{\"resource\":" + PatientData
+        + R"(},{"resource":{"resourceType":"OperationOutcome","issue":[]}}]})";
+    ParquetOutputSet* outputs = nullptr;
+    char* error = new char[256];
+    EXPECT_EQ(11001, ConvertJsonToParquetOutputs(writer, nullptr, 0, PatientData.c_str(), PatientData.size(), &outputs, error));
+
+    int status = ConvertJsonToParquetOutputs(writer, nullptr, 2, bundleData.c_str(), bundleData.size(), &outputs, error);
+    EXPECT_EQ(0, status);
+    EXPECT_EQ(1, GetParquetOutputCount(outputs));
+
+    const char* outputKey = nullptr;
+    const byte* outputData = nullptr;
+    int outputLength = 0;
+    status = GetParquetOutput(outputs, 0, &outputKey, &outputData, &outputLength);
+    EXPECT_EQ(0, status);
+    EXPECT_EQ(resourceType, string(outputKey));
+
+    const auto buffer = std::make_shared<arrow::Buffer>(outputData, outputLength);
+    const std::shared_ptr<arrow::Table> table = parse_buffer_to_table(buffer);
+    check_table_fields_columns(table, get_patient_schema(), 2);
+
+    const char* skippedResourceType = nullptr;
+    EXPECT_EQ(1, GetSkippedResourceTypeCount(outputs));
+    EXPECT_EQ(0, GetSkippedResourceType(outputs, 0, &skippedResourceType));
+    EXPECT_EQ("OperationOutcome", string(skippedResourceType));
+
+    DestroyParquetOutputSet(outputs);
+    DestroyParquetWriter(writer);
+    delete[] error;
+}
+
+TEST (ParquetLib, ReleaseParquetOutputToWriter)
+{
+    ParquetWriter* writer = CreateParquetWriter();
+
+    string resourceType = "Patient";
+    string exampleSchema = read_file_text(TestDataDir + "patient_example_schema.json");
+    int schemaStatus = RegisterParquetSchema(writer, resourceType.data(), exampleSchema.data());
+    EXPECT_EQ(0, schemaStatus);
+
+    byte* outputData = nullptr;
+    int outputLength = 0;
+    char* error = new char[256];
+    int status = ConvertJsonToParquet(writer, resourceType.c_str(), PatientData.c_str(), PatientData.size(), &outputData, &outputLength, error);
+    EXPECT_EQ(0, status);
+
+    EXPECT_EQ(0, ReleaseParquetOutput(writer, &outputData));
+    EXPECT_EQ(nullptr, outputData);
+
+    DestroyParquetWriter(writer);
+    delete[] error;
+}
+
+TEST (ParquetLib, GetStatisticsWithNullOutput)
+{
+    ParquetWriter* writer = CreateParquetWriter();
+
+    string resourceType = "Patient";
+    string exampleSchema = read_file_text(TestDataDir + "patient_example_schema.json");
+    int schemaStatus = RegisterParquetSchema(writer, resourceType.data(), exampleSchema.data());
+    EXPECT_EQ(0, schemaStatus);
+
+    long long rows = 0;
+    EXPECT_EQ(10002, GetConversionStatistics(writer, resourceType.c_str(), nullptr));
+    EXPECT_EQ(10002, GetRecommendedBatchSize(writer, resourceType.c_str(), 1 << 20, 0, nullptr, &rows));
+
+    DestroyParquetWriter(writer);
+}
@@ -0,0 +1,172 @@
+#include "ParquetTestUtilities.h"
+#include "ParquetWriter.h"
+#include <cstdlib>
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+using namespace std;
+
+// Peak memory of a conversion as multiples of the input size. Peak RSS includes the input itself, so it can not go below 1.
+// Raise a budget only when the extra memory is intended, containers are sized from these multiples.
+struct MemoryBudget
+{
+    double pool;
+    double rss;
+};
+
+// Large ndjson inputs are converted pipelined and stay well below one copy of the input in the memory pool.
+static const MemoryBudget PipelinedBudget { 1.0, 2.5 };
+// Bundles and flattened schemas convert the whole input as one table.
+static const MemoryBudget WholeTableBudget { 2.0, 4.0 };
+// Budgets hold for the default size, smaller inputs are dominated by fixed overhead like thread stacks.
+static const int64_t DefaultInputMegabytes = 256;
+
+// Peak resident set size of the process in bytes. The peak can't be reset, so each schema runs in its own ctest process.
+static int64_t GetPeakRss()
+{
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+    return static_cast<int64_t>(counters.PeakWorkingSetSize);
+#else
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return static_cast<int64_t>(usage.ru_maxrss) * 1024;
+#endif
+}
+
+// Input size in bytes, MEMORYTESTINPUTMB overrides the default for quick local runs.
+static int64_t GetInputSize()
+{
+    const char* inputMegabytes = getenv("MEMORYTESTINPUTMB");
+    return (inputMegabytes != nullptr ? atoll(inputMegabytes) : DefaultInputMegabytes) * 1024 * 1024;
+}
+
+// Repeat the lines of the sample data with unique ids until inputSize bytes. The input is reserved up front, so string growth
+// does not add to the peak.
+static string GenerateInput(const string& prefix, const vector<string>& lines, const string& separator, const string& suffix, int64_t inputSize)
+{
+    string input;
+    input.reserve(inputSize + 4096);
+    input += prefix;
+    for (int64_t row = 0; static_cast<int64_t>(input.size()) < inputSize; row++)
+    {
+        const string& line = lines[row % lines.size()];
+        const size_t idStart = line.find("\"id\":\"") + 6;
+        input += row == 0 ? "" : separator;
+        input.append(line, 0, idStart);
+        input += to_string(row);
+        input.append(line, line.find('"', idStart), string::npos);
+    }
+
+    input += suffix;
+    return input;
+}
+
+static vector<string> SplitLines(const string& ndjson)
+{
+    vector<string> lines;
+    istringstream resources(ndjson);
+    string line;
+    while (getline(resources, line))
+    {
+        if (!line.empty())
+        {
+            lines.push_back(line);
+        }
+    }
+
+    return lines;
+}
+
+static vector<string> ReadPatientLines()
+{
+    return SplitLines(read_file_text(TestDataDir + "Patient.ndjson"));
+}
+
+// Convert input and check the peak memory of the conversion against the budgets. Plain ndjson is written to a single output
+// unless writeOutputSet is set, which flattened schemas need.
+static void ExpectConversionWithinBudget(ParquetWriter& writer, const string& resourceType, InputFormat inputFormat, bool writeOutputSet, const string& input, int64_t baselineRss, const MemoryBudget& budget)
+{
+    const int64_t inputSize = static_cast<int64_t>(input.size());
+    char error[256] = "";
+    int status = 0;
+    if (inputFormat == Ndjson && !writeOutputSet)
+    {
+        byte* outputData = nullptr;
+        int outputLength = 0;
+        status = writer.Write(resourceType, input.c_str(), static_cast<int>(inputSize), &outputData, &outputLength, error);
+        writer.ReleaseOutput(outputData);
+    }
+    else
+    {
+        ParquetOutputSet outputs;
+        status = writer.Write(resourceType, inputFormat, input.c_str(), static_cast<int>(inputSize), &outputs, error);
+    }
+
+    EXPECT_EQ(0, status) << error;
+
+    const int64_t poolPeak = arrow::default_memory_pool()->max_memory();
+    const int64_t rssPeak = GetPeakRss() - baselineRss;
+    cout << resourceType << ": input " << inputSize / (1024 * 1024) << " MB, memory pool peak " << poolPeak / (1024 * 1024)
+        << " MB (" << static_cast<double>(poolPeak) / inputSize << "x), RSS peak " << rssPeak / (1024 * 1024)
+        << " MB (" << static_cast<double>(rssPeak) / inputSize << "x)" << endl;
+    if (GetInputSize() != DefaultInputMegabytes * 1024 * 1024)
+    {
+        cout << resourceType << ": budgets are not checked for MEMORYTESTINPUTMB inputs" << endl;
+        return;
+    }
+
+    EXPECT_LE(poolPeak, static_cast<int64_t>(budget.pool * inputSize));
+    EXPECT_LE(rssPeak, static_cast<int64_t>(budget.rss * inputSize));
+}
+
+TEST (ParquetMemory, Patient)
+{
+    const int64_t baselineRss = GetPeakRss();
+    ParquetWriter writer;
+    EXPECT_EQ(0, writer.RegisterSchema("Patient", read_file_text(TestDataDir + "patient_example_schema.json")));
+
+    const string input = GenerateInput("", ReadPatientLines(), "\n", "\n", GetInputSize());
+    ExpectConversionWithinBudget(writer, "Patient", Ndjson, false, input, baselineRss, PipelinedBudget);
+}
+
+TEST (ParquetMemory, PatientBundle)
+{
+    const int64_t baselineRss = GetPeakRss();
+    ParquetWriter writer;
+    EXPECT_EQ(0, writer.RegisterSchema("Patient", read_file_text(TestDataDir + "patient_example_schema.json")));
+
+    vector<string> entries;
+    for (const auto& line : ReadPatientLines())
+    {
+        entries.push_back("{\"fullUrl\":\"urn:uuid:0\",\"resource\":" + line + "}");
+    }
+
+    const string input = GenerateInput("{\"resourceType\":\"Bundle\",\"type\":\"collection\",\"entry\":[", entries, ",", "]}", GetInputSize());
+    ExpectConversionWithinBudget(writer, "Patient", Bundle, true, input, baselineRss, WholeTableBudget);
+}
+
+TEST (ParquetMemory, PatientFlattened)
+{
+    const int64_t baselineRss = GetPeakRss();
+    ParquetWriter writer;
+    EXPECT_EQ(0, writer.RegisterSchema("Patient", read_file_text(TestDataDir + "patient_example_schema.json")));
+    EXPECT_EQ(0, writer.SetFlattenedPaths("Patient", { "name" }));
+
+    const string input = GenerateInput("", ReadPatientLines(), "\n", "\n", GetInputSize());
+    ExpectConversionWithinBudget(writer, "Patient", Ndjson, true, input, baselineRss, WholeTableBudget);
+}
+
+TEST (ParquetMemory, Wide)
+{
+    const int64_t baselineRss = GetPeakRss();
+    ParquetWriter writer;
+    EXPECT_EQ(0, writer.RegisterSchema(WideResourceType, generate_wide_schema(50, 8)));
+
+    const string input = GenerateInput("", SplitLines(generate_wide_resources(100, 50, 8)), "\n", "\n", GetInputSize());
+    ExpectConversionWithinBudget(writer, WideResourceType, Ndjson, false, input, baselineRss, PipelinedBudget);
+}
@@ -118,4 +118,57 @@ void check_table_fields_columns(const std::shared_ptr<arrow::Table>& table, cons
         EXPECT_EQ(expected_num_rows, table->column(i)->length());
         EXPECT_EQ(1, table->column(i)->num_chunks());
     }
-}
\ No newline at end of file
+}
+
+static const std::vector<std::string> wide_leaf_types { "positiveInt", "decimal", "boolean", "string" };
+
+std::string generate_wide_schema(int struct_count, int leaf_count)
+{
+    std::stringstream schema;
+    schema << "{\"Name\":\"" << WideResourceType << "\",\"Type\":\"" << WideResourceType << "\",\"IsRepeated\":false,\"SubNodes\":{";
+    schema << "\"resourceType\":{\"Name\":\"resourceType\",\"Type\":\"string\",\"IsLeaf\":true,\"IsRepeated\":false}";
+    schema << ",\"id\":{\"Name\":\"id\",\"Type\":\"id\",\"IsLeaf\":true,\"IsRepeated\":false}";
+    for (int i = 0; i < struct_count; i++)
+    {
+        schema << ",\"s" << i << "\":{\"Name\":\"s" << i << "\",\"Type\":\"Element\",\"IsLeaf\":false,\"IsRepeated\":false,\"SubNodes\":{";
+        for (int j = 0; j < leaf_count; j++)
+        {
+            schema << (j == 0 ? "" : ",") << "\"f" << j << "\":{\"Name\":\"f" << j << "\",\"Type\":\"" << wide_leaf_types[j % wide_leaf_types.size()] << "\",\"IsLeaf\":true,\"IsRepeated\":false}";
+        }
+
+        schema << "}}";
+    }
+
+    schema << "}}";
+    return schema.str();
+}
+
+std::string generate_wide_resources(int row_count, int struct_count, int leaf_count)
+{
+    std::stringstream resources;
+    for (int row = 0; row < row_count; row++)
+    {
+        resources << "{\"resourceType\":\"" << WideResourceType << "\",\"id\":\"" << row << "\"";
+        for (int i = 0; i < struct_count; i++)
+        {
+            resources << ",\"s" << i << "\":{";
+            for (int j = 0; j < leaf_count; j++)
+            {
+                resources << (j == 0 ? "" : ",") << "\"f" << j << "\":";
+                switch (j % wide_leaf_types.size())
+                {
+                    case 0: resources << (row * 7 + j) % 1000; break;
+                    case 1: resources << (row % 997) * 0.25; break;
+                    case 2: resources << (row % 3 == 0 ? "true" : "false"); break;
+                    default: resources << "\"value-" << (row * 31 + i) % 5000 << "\""; break;
+                }
+            }
+
+            resources << "}";
+        }
+
+        resources << "}\n";
+    }
+
+    return resources.str();
+}
@@ -1,17 +1,23 @@
 #pragma once
 #include <arrow/api.h>
+#include <arrow/c/bridge.h>
 #include <arrow/io/api.h>
 #include <arrow/ipc/api.h>
 #include <parquet/arrow/reader.h>
 #include <parquet/arrow/writer.h>
 #include <fstream>
 #include <gtest/gtest.h>
+#include <condition_variable>
+#include <mutex>
+#include <sstream>
 #include <string>
 
 using namespace std;
 
-static string TestDataDir = string(std::getenv("TESTDATADIR"));
+// TESTDATADIR is unset for the benchmarks, which only use the generated wide schema.
+static string TestDataDir = std::getenv("TESTDATADIR") != nullptr ? string(std::getenv("TESTDATADIR")) : string();
 static string ExpectedDataDir = TestDataDir + "Expected/";
+static string WideResourceType = "Wide";
 static string PatientData = R"({"resourceType":"Patient","id":"UnittTest","name":[{"use":"official","family":"Chalmers","given":["Peter","James"]},{"use":"usual","given":["Jim"]}],"gender":"male","birthDate":"1974-12-25","deceasedBoolean":false,"managingOrganization":{"reference":"Organization / 1"}})";
 
 std::vector<std::shared_ptr<arrow::Field>> get_patient_fields();
@@ -21,3 +27,8 @@ std::string read_file_to_buffer(const std::string& file_path);
 std::string read_file_text(const std::string& file_path);
 std::shared_ptr<arrow::Table> parse_buffer_to_table(std::shared_ptr<arrow::Buffer> res, arrow::Compression::type compression = arrow::Compression::SNAPPY);
 void check_table_fields_columns(const std::shared_ptr<arrow::Table>& table, const std::shared_ptr<arrow::Schema>& schema, int64_t expected_num_rows = 1);
+
+// Schema with struct_count struct fields of leaf_count leaves each, in the same format as the generated FHIR schemas.
+std::string generate_wide_schema(int struct_count, int leaf_count);
+// Ndjson resources of the wide schema, one per line with the row number as id.
+std::string generate_wide_resources(int row_count, int struct_count, int leaf_count);
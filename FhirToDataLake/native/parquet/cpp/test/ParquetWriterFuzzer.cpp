@@ -0,0 +1,64 @@
+#include "ParquetWriter.h"
+#include <cstdint>
+using namespace std;
+
+// Schema covering every leaf type, a repeated struct, a repeated leaf and a flattened path.
+static const string FuzzSchema = R"({
+    "Name": "Fuzz", "Type": "Fuzz", "IsRepeated": false, "IsLeaf": false,
+    "SubNodes": {
+        "resourceType": { "Name": "resourceType", "Type": "string", "IsRepeated": false, "IsLeaf": true, "SubNodes": null },
+        "id": { "Name": "id", "Type": "id", "IsRepeated": false, "IsLeaf": true, "SubNodes": null },
+        "count": { "Name": "count", "Type": "integer", "IsRepeated": false, "IsLeaf": true, "SubNodes": null },
+        "value": { "Name": "value", "Type": "decimal", "IsRepeated": false, "IsLeaf": true, "SubNodes": null },
+        "active": { "Name": "active", "Type": "boolean", "IsRepeated": false, "IsLeaf": true, "SubNodes": null },
+        "tag": { "Name": "tag", "Type": "string", "IsRepeated": true, "IsLeaf": true, "SubNodes": null },
+        "item": {
+            "Name": "item", "Type": "Item", "IsRepeated": true, "IsLeaf": false,
+            "SubNodes": {
+                "code": { "Name": "code", "Type": "code", "IsRepeated": false, "IsLeaf": true, "SubNodes": null },
+                "rank": { "Name": "rank", "Type": "positiveInt", "IsRepeated": false, "IsLeaf": true, "SubNodes": null }
+            }
+        }
+    }
+})";
+
+static ParquetWriter* CreateFuzzWriter()
+{
+    ParquetWriter* writer = new ParquetWriter();
+    writer->RegisterSchema("Fuzz", FuzzSchema);
+    writer->RegisterSchema("Flattened", FuzzSchema);
+    writer->SetFlattenedPaths("Flattened", { "item", "tag" });
+    return writer;
+}
+
+// The first byte selects the input format and the schema key, the rest is the input json.
+// Any input must return a status code, crashes and sanitizer reports are failures.
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+    static ParquetWriter* writer = CreateFuzzWriter();
+    if (size == 0)
+    {
+        return 0;
+    }
+
+    const InputFormat inputFormat = static_cast<InputFormat>(data[0] % 4);
+    const string schemaKey = data[0] & 0x80 ? "Flattened" : "Fuzz";
+    const char* inputJson = reinterpret_cast<const char*>(data + 1);
+    const int inputLength = static_cast<int>(size - 1);
+    char errorMessage[256] = "";
+    if (inputFormat == Ndjson && schemaKey == "Fuzz")
+    {
+        byte* outputData = nullptr;
+        int outputLength = 0;
+        if (writer->Write(schemaKey, inputJson, inputLength, &outputData, &outputLength, errorMessage) == 0)
+        {
+            writer->ReleaseOutput(outputData);
+        }
+
+        return 0;
+    }
+
+    ParquetOutputSet outputs;
+    writer->Write(schemaKey, inputFormat, inputJson, inputLength, &outputs, errorMessage);
+    return 0;
+}
@@ -1,4 +1,5 @@
 #include "ParquetTestUtilities.h"
+#include "ParquetLib.h"
 #include "ParquetWriter.h"
 using namespace std;
 
@@ -183,7 +184,7 @@ TEST (ParquetWriter, WriteExamplePatient)
     const auto expected_table = get_expected_patient_table();
     EXPECT_TRUE(expected_table->Equals(*table));
 
-    delete *outputData;
+    writer.ReleaseOutput(*outputData);
     delete outputData;
 }
 
@@ -215,6 +216,1353 @@ TEST (ParquetWriter, WriteBatchPatient)
     const std::shared_ptr<arrow::Table> table = parse_buffer_to_table(buffer);
     EXPECT_EQ(7, table->num_rows());
 
-    delete *outputData;
+    writer.ReleaseOutput(*outputData);
     delete outputData;
-}
\ No newline at end of file
+}
+
+TEST (ParquetWriter, WriteExamplePatientToArrowIpc)
+{
+    byte** outputData = new byte*[1];
+    int outputLength = 0;
+    string resourceType = "Patient";
+    string exampleSchema = read_file_text(TestDataDir + "patient_example_schema.json");
+    ParquetWriter writer;
+    int schemaStatus = writer.RegisterSchema(resourceType, exampleSchema);
+    EXPECT_EQ(0, schemaStatus);
+
+    char error[256] = "";
+    int status = writer.WriteArrowIpc(resourceType, PatientData.c_str(), static_cast<int>(PatientData.size()), outputData, &outputLength, error);
+    // Write success.
+    EXPECT_EQ(0, status);
+    EXPECT_TRUE(outputLength > 0);
+    EXPECT_EQ("", std::string(error));
+
+    // read the arrow IPC file back to table, and check it.
+    const auto buffer = std::make_shared<arrow::Buffer>(*outputData, outputLength);
+    const auto buffer_reader = std::make_shared<arrow::io::BufferReader>(buffer);
+    const auto file_reader = arrow::ipc::RecordBatchFileReader::Open(buffer_reader).ValueOrDie();
+    EXPECT_EQ(1, file_reader->num_record_batches());
+
+    const auto table = arrow::Table::FromRecordBatches({ file_reader->ReadRecordBatch(0).ValueOrDie() }).ValueOrDie();
+    check_table_fields_columns(table, get_patient_schema());
+    const auto expected_table = get_expected_patient_table();
+    EXPECT_TRUE(expected_table->Equals(*table));
+
+    TryReleaseUnmanagedData(outputData);
+    delete outputData;
+}
+
+TEST (ParquetWriter, WriteExamplePatientToArrowStream)
+{
+    string resourceType = "Patient";
+    string exampleSchema = read_file_text(TestDataDir + "patient_example_schema.json");
+    ParquetWriter writer;
+    int schemaStatus = writer.RegisterSchema(resourceType, exampleSchema);
+    EXPECT_EQ(0, schemaStatus);
+
+    struct ArrowArrayStream stream;
+    char error[256] = "";
+    int status = writer.WriteArrowStream(resourceType, PatientData.c_str(), static_cast<int>(PatientData.size()), &stream, error);
+    // Write success.
+    EXPECT_EQ(0, status);
+    EXPECT_EQ("", std::string(error));
+
+    // import the C stream as a record batch reader, the imported reader releases the stream.
+    const auto reader = arrow::ImportRecordBatchReader(&stream).ValueOrDie();
+    const auto table = arrow::Table::FromRecordBatchReader(reader.get()).ValueOrDie();
+    check_table_fields_columns(table, get_patient_schema());
+    const auto expected_table = get_expected_patient_table();
+    EXPECT_TRUE(expected_table->Equals(*table));
+}
+
+TEST (ParquetWriter, WriteArrowStreamWithNullOutputPointer)
+{
+    string resourceType = "Patient";
+    string exampleSchema = read_file_text(TestDataDir + "patient_example_schema.json");
+    ParquetWriter writer;
+    int schemaStatus = writer.RegisterSchema(resourceType, exampleSchema);
+    EXPECT_EQ(0, schemaStatus);
+
+    char error[256] = "";
+    int status = writer.WriteArrowStream(resourceType, PatientData.c_str(), static_cast<int>(PatientData.size()), nullptr, error);
+
+    EXPECT_EQ(10003, status);
+    EXPECT_EQ("Output stream pointer is null.", std::string(error));
+}
+
+TEST (ParquetWriter, CompactBatchPatient)
+{
+    string resourceType = "Patient";
+    string exampleSchema = read_file_text(TestDataDir + "patient_example_schema.json");
+    ParquetWriter writer;
+    int schemaStatus = writer.RegisterSchema(resourceType, exampleSchema);
+    EXPECT_EQ(0, schemaStatus);
+
+    // convert the batch three times to get three single row group inputs.
+    string batchPatientData = read_file_text(TestDataDir + "Patient.ndjson");
+    vector<shared_ptr<arrow::Buffer>> inputs;
+    for (int i = 0; i < 3; i++)
+    {
+        byte* outputData = nullptr;
+        int outputLength = 0;
+        int status = writer.Write(resourceType, batchPatientData.c_str(), static_cast<int>(batchPatientData.size()), &outputData, &outputLength);
+        EXPECT_EQ(0, status);
+        inputs.push_back(arrow::Buffer::FromString(string(reinterpret_cast<char*>(outputData), outputLength)));
+        writer.ReleaseOutput(outputData);
+    }
+
+    InputFileFactory openInput = [&](int inputIndex) -> arrow::Result<shared_ptr<arrow::io::RandomAccessFile>>
+    {
+        return make_shared<arrow::io::BufferReader>(inputs[inputIndex]);
+    };
+
+    vector<shared_ptr<arrow::io::BufferOutputStream>> outputStreams;
+    OutputStreamFactory openOutput = [&](int outputIndex) -> arrow::Result<shared_ptr<arrow::io::OutputStream>>
+    {
+        outputStreams.push_back(arrow::io::BufferOutputStream::Create().ValueOrDie());
+        return outputStreams.back();
+    };
+
+    int outputCount = 0;
+    char error[256] = "";
+    int status = writer.Compact(resourceType, openInput, static_cast<int>(inputs.size()), openOutput, 0, &outputCount, error);
+    EXPECT_EQ(0, status);
+    EXPECT_EQ("", std::string(error));
+    EXPECT_EQ(1, outputCount);
+
+    // small inputs are merged into a single row group.
+    const auto table = parse_buffer_to_table(outputStreams[0]->Finish().ValueOrDie());
+    EXPECT_EQ(21, table->num_rows());
+    EXPECT_TRUE(table->schema()->Equals(get_patient_schema(), true));
+
+    // a tiny target size rolls over to a new output after every row group.
+    outputStreams.clear();
+    status = writer.Compact(resourceType, openInput, static_cast<int>(inputs.size()), openOutput, 1, &outputCount, error);
+    EXPECT_EQ(0, status);
+    EXPECT_EQ(3, outputCount);
+    for (const auto& outputStream : outputStreams)
+    {
+        EXPECT_EQ(7, parse_buffer_to_table(outputStream->Finish().ValueOrDie())->num_rows());
+    }
+}
+
+// Sum of the compressed column chunks of a row group.
+static int64_t GetCompressedSize(const parquet::RowGroupMetaData& rowGroup)
+{
+    int64_t compressedSize = 0;
+    for (int i = 0; i < rowGroup.num_columns(); i++)
+    {
+        compressedSize += rowGroup.ColumnChunk(i)->total_compressed_size();
+    }
+
+    return compressedSize;
+}
+
+TEST (ParquetWriter, CompactToTargetFileSize)
+{
+    string resourceType = "Patient";
+    string exampleSchema = read_file_text(TestDataDir + "patient_example_schema.json");
+    ParquetWriter writer;
+    int schemaStatus = writer.RegisterSchema(resourceType, exampleSchema);
+    EXPECT_EQ(0, schemaStatus);
+
+    // Repeated resources compress well, so an input row group is above the target uncompressed and below it compressed.
+    string batchPatientData;
+    for (int i = 0; i < 100; i++)
+    {
+        batchPatientData += read_file_text(TestDataDir + "Patient.ndjson");
+    }
+
+    vector<shared_ptr<arrow::Buffer>> inputs;
+    for (int i = 0; i < 8; i++)
+    {
+        byte* outputData = nullptr;
+        int outputLength = 0;
+        int status = writer.Write(resourceType, batchPatientData.c_str(), static_cast<int>(batchPatientData.size()), &outputData, &outputLength);
+        EXPECT_EQ(0, status);
+        inputs.push_back(arrow::Buffer::FromString(string(reinterpret_cast<char*>(outputData), outputLength)));
+        writer.ReleaseOutput(outputData);
+    }
+
+    const auto inputMetadata = parquet::ParquetFileReader::Open(make_shared<arrow::io::BufferReader>(inputs[0]))->metadata();
+    const int64_t rowGroupSize = GetCompressedSize(*inputMetadata->RowGroup(0));
+    const int64_t targetFileSize = rowGroupSize * 3 / 2;
+    ASSERT_LT(targetFileSize, inputMetadata->RowGroup(0)->total_byte_size());
+
+    InputFileFactory openInput = [&](int inputIndex) -> arrow::Result<shared_ptr<arrow::io::RandomAccessFile>>
+    {
+        return make_shared<arrow::io::BufferReader>(inputs[inputIndex]);
+    };
+
+    vector<shared_ptr<arrow::io::BufferOutputStream>> outputStreams;
+    OutputStreamFactory openOutput = [&](int outputIndex) -> arrow::Result<shared_ptr<arrow::io::OutputStream>>
+    {
+        outputStreams.push_back(arrow::io::BufferOutputStream::Create().ValueOrDie());
+        return outputStreams.back();
+    };
+
+    // The target falls between one and two row groups, so every output is closed right after its second row group.
+    int outputCount = 0;
+    char error[256] = "";
+    int status = writer.Compact(resourceType, openInput, static_cast<int>(inputs.size()), openOutput, targetFileSize, &outputCount, error);
+    EXPECT_EQ(0, status);
+    EXPECT_EQ("", std::string(error));
+    EXPECT_EQ(4, outputCount);
+    for (const auto& outputStream : outputStreams)
+    {
+        const auto metadata = parquet::ParquetFileReader::Open(make_shared<arrow::io::BufferReader>(outputStream->Finish().ValueOrDie()))->metadata();
+        ASSERT_EQ(2, metadata->num_row_groups());
+        EXPECT_LT(GetCompressedSize(*metadata->RowGroup(0)), targetFileSize);
+        EXPECT_EQ(2 * inputMetadata->num_rows(), metadata->num_rows());
+    }
+}
+
+TEST (ParquetWriter, CompactWithMismatchedSchema)
+{
+    string exampleSchema = read_file_text(TestDataDir + "patient_example_schema.json");
+    string organizationSchema = "{\"Name\": \"Organization\", \"NodePaths\": [\"Organization\"], \"SubNodes\": { \"id\": {\"Name\":\"id\", \"Depth\": 1, \"Type\": \"id\", \"IsLeaf\": true, \"IsRepeated\": false}}, \"Type\": \"Organization\", \"IsRepeated\": false}";
+    ParquetWriter writer;
+    EXPECT_EQ(0, writer.RegisterSchema("Patient", exampleSchema));
+    EXPECT_EQ(0, writer.RegisterSchema("Organization", organizationSchema));
+
+    byte* outputData = nullptr;
+    int outputLength = 0;
+    int status = writer.Write("Patient", PatientData.c_str(), static_cast<int>(PatientData.size()), &outputData, &outputLength);
+    EXPECT_EQ(0, status);
+    const auto input = arrow::Buffer::FromString(string(reinterpret_cast<char*>(outputData), outputLength));
+    writer.ReleaseOutput(outputData);
+
+    InputFileFactory openInput = [&](int inputIndex) -> arrow::Result<shared_ptr<arrow::io::RandomAccessFile>>
+    {
+        return make_shared<arrow::io::BufferReader>(input);
+    };
+
+    OutputStreamFactory openOutput = [&](int outputIndex) -> arrow::Result<shared_ptr<arrow::io::OutputStream>>
+    {
+        return arrow::io::BufferOutputStream::Create();
+    };
+
+    int outputCount = 0;
+    char error[256] = "";
+    status = writer.Compact("Organization", openInput, 1, openOutput, 0, &outputCount, error);
+    EXPECT_EQ(10004, status);
+    EXPECT_EQ(0, outputCount);
+    EXPECT_EQ("Schema of parquet input 0 does not match the target schema.", std::string(error));
+}
+
+struct AsyncConversionState
+{
+    mutex stateMutex;
+    condition_variable stateChanged;
+    vector<int> statuses;
+    vector<int> outputLengths;
+    int runningCallbacks = 0;
+    bool releaseCallbacks = true;
+};
+
+// Record the result, then block inside the callback until the test releases it, which keeps the job in flight.
+void RecordAsyncConversion(long long jobId, int status, byte* outputData, int outputLength, const char* errorMessage, void* state)
+{
+    AsyncConversionState* conversionState = static_cast<AsyncConversionState*>(state);
+    unique_lock<mutex> lock(conversionState->stateMutex);
+    conversionState->statuses.push_back(status);
+    conversionState->outputLengths.push_back(outputLength);
+    conversionState->runningCallbacks++;
+    conversionState->stateChanged.notify_all();
+    conversionState->stateChanged.wait(lock, [conversionState] { return conversionState->releaseCallbacks; });
+    conversionState->runningCallbacks--;
+    OutputBufferPool::FreeOutput(outputData);
+}
+
+TEST (ParquetWriter, WriteAsyncExamplePatient)
+{
+    string resourceType = "Patient";
+    string exampleSchema = read_file_text(TestDataDir + "patient_example_schema.json");
+    AsyncConversionState state;
+    {
+        ParquetWriter writer;
+        int schemaStatus = writer.RegisterSchema(resourceType, exampleSchema);
+        EXPECT_EQ(0, schemaStatus);
+
+        long long jobId = 0;
+        char error[256] = "";
+        int status = writer.WriteAsync(resourceType, PatientData.c_str(), static_cast<int>(PatientData.size()), RecordAsyncConversion, &state, &jobId, error);
+        EXPECT_EQ(0, status);
+        EXPECT_TRUE(jobId > 0);
+
+        unique_lock<mutex> lock(state.stateMutex);
+        state.stateChanged.wait(lock, [&state] { return state.statuses.size() == 1; });
+    }
+
+    EXPECT_EQ(0, state.statuses[0]);
+    EXPECT_TRUE(state.outputLengths[0] > 0);
+}
+
+TEST (ParquetWriter, WriteAsyncWithInFlightLimit)
+{
+    string resourceType = "Patient";
+    string exampleSchema = read_file_text(TestDataDir + "patient_example_schema.json");
+    AsyncConversionState state;
+    state.releaseCallbacks = false;
+
+    ParquetWriter writer;
+    int schemaStatus = writer.RegisterSchema(resourceType, exampleSchema);
+    EXPECT_EQ(0, schemaStatus);
+    EXPECT_EQ(0, writer.SetMaxInFlightJobs(1));
+
+    long long jobId = 0;
+    char error[256] = "";
+    int status = writer.WriteAsync(resourceType, PatientData.c_str(), static_cast<int>(PatientData.size()), RecordAsyncConversion, &state, &jobId, error);
+    EXPECT_EQ(0, status);
+
+    // The first job is held in its callback, so the second one is rejected.
+    {
+        unique_lock<mutex> lock(state.stateMutex);
+        state.stateChanged.wait(lock, [&state] { return state.runningCallbacks == 1; });
+    }
+
+    status = writer.WriteAsync(resourceType, PatientData.c_str(), static_cast<int>(PatientData.size()), RecordAsyncConversion, &state, &jobId, error);
+    EXPECT_EQ(12002, status);
+    EXPECT_EQ("Too many conversions in flight, the limit is 1.", std::string(error));
+
+    {
+        lock_guard<mutex> lock(state.stateMutex);
+        state.releaseCallbacks = true;
+        state.stateChanged.notify_all();
+    }
+}
+
+TEST (ParquetWriter, CancelQueuedAsyncConversion)
+{
+    string resourceType = "Patient";
+    string exampleSchema = read_file_text(TestDataDir + "patient_example_schema.json");
+    AsyncConversionState state;
+    state.releaseCallbacks = false;
+
+    ParquetWriter writer;
+    int schemaStatus = writer.RegisterSchema(resourceType, exampleSchema);
+    EXPECT_EQ(0, schemaStatus);
+
+    // Occupy every executor thread with a job held in its callback, then queue one more job.
+    long long jobId = 0;
+    char error[256] = "";
+    for (int i = 0; i < ParquetOptions::AsyncThreadCount; i++)
+    {
+        EXPECT_EQ(0, writer.WriteAsync(resourceType, PatientData.c_str(), static_cast<int>(PatientData.size()), RecordAsyncConversion, &state, &jobId, error));
+    }
+
+    {
+        unique_lock<mutex> lock(state.stateMutex);
+        state.stateChanged.wait(lock, [&state] { return state.runningCallbacks == ParquetOptions::AsyncThreadCount; });
+    }
+
+    EXPECT_EQ(0, writer.WriteAsync(resourceType, PatientData.c_str(), static_cast<int>(PatientData.size()), RecordAsyncConversion, &state, &jobId, error));
+    EXPECT_EQ(0, writer.CancelAsync(jobId));
+    EXPECT_EQ(12003, writer.CancelAsync(jobId + 1));
+
+    {
+        unique_lock<mutex> lock(state.stateMutex);
+        state.releaseCallbacks = true;
+        state.stateChanged.notify_all();
+        state.stateChanged.wait(lock, [&state] { return state.statuses.size() == ParquetOptions::AsyncThreadCount + 1; });
+    }
+
+    EXPECT_EQ(12001, state.statuses.back());
+    EXPECT_EQ(0, state.outputLengths.back());
+}
+
+TEST (ParquetWriter, WriteAsyncWithConfigurationWhenQueued)
+{
+    string resourceType = "Patient";
+    string exampleSchema = read_file_text(TestDataDir + "patient_example_schema.json");
+    AsyncConversionState state;
+    state.releaseCallbacks = false;
+
+    ParquetWriter writer;
+    int schemaStatus = writer.RegisterSchema(resourceType, exampleSchema);
+    EXPECT_EQ(0, schemaStatus);
+
+    // Occupy every executor thread with a job held in its callback, then queue one more job.
+    long long jobId = 0;
+    char error[256] = "";
+    for (int i = 0; i <= ParquetOptions::AsyncThreadCount; i++)
+    {
+        EXPECT_EQ(0, writer.WriteAsync(resourceType, PatientData.c_str(), static_cast<int>(PatientData.size()), RecordAsyncConversion, &state, &jobId, error));
+    }
+
+    {
+        unique_lock<mutex> lock(state.stateMutex);
+        state.stateChanged.wait(lock, [&state] { return state.runningCallbacks == ParquetOptions::AsyncThreadCount; });
+    }
+
+    // Configuration changes while jobs are in flight don't apply to the queued job, so its output is the same plain parquet.
+    EncryptionKeys keys;
+    keys.footerKey = "0123456789abcdef";
+    for (int i = 0; i < 10; i++)
+    {
+        EXPECT_EQ(0, writer.RegisterSchema(resourceType, exampleSchema));
+        EXPECT_EQ(0, writer.SetEncryptionKeys(resourceType, keys, error));
+        EXPECT_EQ(0, writer.SetFlattenedPaths(resourceType, { "name" }, error));
+    }
+
+    {
+        unique_lock<mutex> lock(state.stateMutex);
+        state.releaseCallbacks = true;
+        state.stateChanged.notify_all();
+        state.stateChanged.wait(lock, [&state] { return state.statuses.size() == ParquetOptions::AsyncThreadCount + 1; });
+    }
+
+    for (size_t i = 0; i < state.statuses.size(); i++)
+    {
+        EXPECT_EQ(0, state.statuses[i]);
+        EXPECT_EQ(state.outputLengths[0], state.outputLengths[i]);
+    }
+}
+
+TEST (ParquetWriter, WritePipelinedBatchPatient)
+{
+    string resourceType = "Patient";
+    string exampleSchema = read_file_text(TestDataDir + "patient_example_schema.json");
+    string batchPatientData = read_file_text(TestDataDir + "Patient.ndjson");
+    ParquetWriter writer;
+    int schemaStatus = writer.RegisterSchema(resourceType, exampleSchema);
+    EXPECT_EQ(0, schemaStatus);
+
+    byte* outputData = nullptr;
+    int outputLength = 0;
+    int status = writer.Write(resourceType, batchPatientData.c_str(), static_cast<int>(batchPatientData.size()), &outputData, &outputLength);
+    EXPECT_EQ(0, status);
+    const auto expected_table = parse_buffer_to_table(arrow::Buffer::FromString(string(reinterpret_cast<char*>(outputData), outputLength)));
+    writer.ReleaseOutput(outputData);
+
+    // Chunks smaller than a line hold one resource each.
+    EXPECT_EQ(0, writer.SetPipelineChunkSize(16));
+    char error[256] = "";
+    status = writer.Write(resourceType, batchPatientData.c_str(), static_cast<int>(batchPatientData.size()), &outputData, &outputLength, error);
+    EXPECT_EQ(0, status);
+    EXPECT_EQ("", std::string(error));
+
+    const auto buffer = arrow::Buffer::FromString(string(reinterpret_cast<char*>(outputData), outputLength));
+    const auto buffer_reader = std::make_shared<arrow::io::BufferReader>(buffer);
+    std::unique_ptr<parquet::arrow::FileReader> reader;
+    PARQUET_THROW_NOT_OK(parquet::arrow::OpenFile(buffer_reader, arrow::default_memory_pool(), &reader));
+    EXPECT_EQ(7, reader->num_row_groups());
+
+    const auto table = parse_buffer_to_table(buffer);
+    EXPECT_TRUE(expected_table->Equals(*table));
+    writer.ReleaseOutput(outputData);
+}
+
+TEST (ParquetWriter, WritePipelinedWithBlankChunks)
+{
+    string resourceType = "Patient";
+    string exampleSchema = read_file_text(TestDataDir + "patient_example_schema.json");
+    string batchPatientData = read_file_text(TestDataDir + "Patient.ndjson");
+    ParquetWriter writer;
+    int schemaStatus = writer.RegisterSchema(resourceType, exampleSchema);
+    EXPECT_EQ(0, schemaStatus);
+
+    byte* outputData = nullptr;
+    int outputLength = 0;
+    int status = writer.Write(resourceType, batchPatientData.c_str(), static_cast<int>(batchPatientData.size()), &outputData, &outputLength);
+    EXPECT_EQ(0, status);
+    const auto expected_table = parse_buffer_to_table(arrow::Buffer::FromString(string(reinterpret_cast<char*>(outputData), outputLength)));
+    writer.ReleaseOutput(outputData);
+
+    // Blank lines longer than a chunk are skipped, the lines after them are still converted.
+    const string blankLines(40, '\n');
+    char error[256] = "";
+    char pipelinedError[256] = "";
+    byte* blankOutputData = nullptr;
+    int blankOutputLength = 0;
+    const int blankStatus = writer.Write(resourceType, blankLines.c_str(), static_cast<int>(blankLines.size()), &blankOutputData, &blankOutputLength, error);
+    EXPECT_EQ(0, writer.SetPipelineChunkSize(16));
+    const string paddedData = blankLines + batchPatientData + blankLines + batchPatientData;
+    status = writer.Write(resourceType, paddedData.c_str(), static_cast<int>(paddedData.size()), &outputData, &outputLength, pipelinedError);
+    EXPECT_EQ(0, status);
+    EXPECT_EQ(2 * expected_table->num_rows(), parse_buffer_to_table(arrow::Buffer::FromString(string(reinterpret_cast<char*>(outputData), outputLength)))->num_rows());
+    writer.ReleaseOutput(outputData);
+
+    // Input of only blank lines converts the same way with and without the pipeline, arrow versions differ in whether it is an empty file error.
+    outputData = nullptr;
+    outputLength = 0;
+    status = writer.Write(resourceType, blankLines.c_str(), static_cast<int>(blankLines.size()), &outputData, &outputLength, pipelinedError);
+    EXPECT_EQ(blankStatus, status);
+    EXPECT_EQ(std::string(error), std::string(pipelinedError));
+    EXPECT_EQ(blankOutputLength, outputLength);
+    writer.ReleaseOutput(blankOutputData);
+    writer.ReleaseOutput(outputData);
+}
+
+TEST (ParquetWriter, WritePipelinedStreamedPatient)
+{
+    string resourceType = "Patient";
+    string exampleSchema = read_file_text(TestDataDir + "patient_example_schema.json");
+    string batchPatientData = read_file_text(TestDataDir + "Patient.ndjson");
+    ParquetWriter writer;
+    int schemaStatus = writer.RegisterSchema(resourceType, exampleSchema);
+    EXPECT_EQ(0, schemaStatus);
+
+    byte* outputData = nullptr;
+    int outputLength = 0;
+    int status = writer.Write(resourceType, batchPatientData.c_str(), static_cast<int>(batchPatientData.size()), &outputData, &outputLength);
+    EXPECT_EQ(0, status);
+    const auto expected_table = parse_buffer_to_table(arrow::Buffer::FromString(string(reinterpret_cast<char*>(outputData), outputLength)));
+    writer.ReleaseOutput(outputData);
+
+    // Chunks longer than every line are parsed by the streaming json reader from arrow 11, chunks end inside lines.
+    EXPECT_EQ(0, writer.SetPipelineChunkSize(600));
+    char error[256] = "";
+    status = writer.Write(resourceType, batchPatientData.c_str(), static_cast<int>(batchPatientData.size()), &outputData, &outputLength, error);
+    EXPECT_EQ(0, status);
+    EXPECT_EQ("", std::string(error));
+
+    const auto buffer = arrow::Buffer::FromString(string(reinterpret_cast<char*>(outputData), outputLength));
+    const auto buffer_reader = std::make_shared<arrow::io::BufferReader>(buffer);
+    std::unique_ptr<parquet::arrow::FileReader> reader;
+    PARQUET_THROW_NOT_OK(parquet::arrow::OpenFile(buffer_reader, arrow::default_memory_pool(), &reader));
+    EXPECT_LT(1, reader->num_row_groups());
+
+    const auto table = parse_buffer_to_table(buffer);
+    EXPECT_TRUE(expected_table->Equals(*table));
+    writer.ReleaseOutput(outputData);
+
+    const string invalidData = batchPatientData + "\n{\"id\":";
+    outputData = nullptr;
+    outputLength = 0;
+    status = writer.Write(resourceType, invalidData.c_str(), static_cast<int>(invalidData.size()), &outputData, &outputLength, error);
+    EXPECT_EQ(10001, status);
+    EXPECT_EQ(0, outputLength);
+    EXPECT_NE("", std::string(error));
+}
+
+TEST (ParquetWriter, WritePipelinedInvalidPatient)
+{
+    string resourceType = "Patient";
+    string exampleSchema = read_file_text(TestDataDir + "patient_example_schema.json");
+    string batchPatientData = read_file_text(TestDataDir + "Patient.ndjson") + "\n{\"id\":";
+    ParquetWriter writer;
+    int schemaStatus = writer.RegisterSchema(resourceType, exampleSchema);
+    EXPECT_EQ(0, schemaStatus);
+    EXPECT_EQ(0, writer.SetPipelineChunkSize(16));
+
+    byte* outputData = nullptr;
+    int outputLength = 0;
+    char error[256] = "";
+    int status = writer.Write(resourceType, batchPatientData.c_str(), static_cast<int>(batchPatientData.size()), &outputData, &outputLength, error);
+    EXPECT_EQ(10001, status);
+    EXPECT_EQ(0, outputLength);
+    EXPECT_NE("", std::string(error));
+}
+
+TEST (ParquetWriter, ReuseReleasedOutputBuffer)
+{
+    string resourceType = "Patient";
+    string exampleSchema = read_file_text(TestDataDir + "patient_example_schema.json");
+    string batchPatientData = read_file_text(TestDataDir + "Patient.ndjson");
+    ParquetWriter writer;
+    int schemaStatus = writer.RegisterSchema(resourceType, exampleSchema);
+    EXPECT_EQ(0, schemaStatus);
+
+    byte* firstOutput = nullptr;
+    int firstLength = 0;
+    int status = writer.Write(resourceType, batchPatientData.c_str(), static_cast<int>(batchPatientData.size()), &firstOutput, &firstLength);
+    EXPECT_EQ(0, status);
+    const string firstResult(reinterpret_cast<char*>(firstOutput), firstLength);
+    writer.ReleaseOutput(firstOutput);
+
+    // The released buffer is handed out again for the next output of the same size.
+    byte* secondOutput = nullptr;
+    int secondLength = 0;
+    status = writer.Write(resourceType, batchPatientData.c_str(), static_cast<int>(batchPatientData.size()), &secondOutput, &secondLength);
+    EXPECT_EQ(0, status);
+    EXPECT_EQ(firstOutput, secondOutput);
+    EXPECT_EQ(firstResult, string(reinterpret_cast<char*>(secondOutput), secondLength));
+    writer.ReleaseOutput(secondOutput);
+}
+
+TEST (ParquetWriter, WriteJsonArrayPatient)
+{
+    string resourceType = "Patient";
+    string exampleSchema = read_file_text(TestDataDir + "patient_example_schema.json");
+    string batchPatientData = read_file_text(TestDataDir + "Patient.ndjson");
+    ParquetWriter writer;
+    int schemaStatus = writer.RegisterSchema(resourceType, exampleSchema);
+    EXPECT_EQ(0, schemaStatus);
+
+    // Pretty printed array of the same resources.
+    string arrayPatientData = "[\n  ";
+    istringstream lines(batchPatientData);
+    string line;
+    while (getline(lines, line))
+    {
+        if (!line.empty())
+        {
+            arrayPatientData += line.replace(line.find(",\"gender\""), 1, ",\n    ") + ",\n  ";
+        }
+    }
+    arrayPatientData.replace(arrayPatientData.size() - 4, 4, "\n]\n");
+
+    byte* outputData = nullptr;
+    int outputLength = 0;
+    int status = writer.Write(resourceType, batchPatientData.c_str(), static_cast<int>(batchPatientData.size()), &outputData, &outputLength);
+    EXPECT_EQ(0, status);
+    const auto expected_table = parse_buffer_to_table(arrow::Buffer::FromString(string(reinterpret_cast<char*>(outputData), outputLength)));
+    writer.ReleaseOutput(outputData);
+
+    ParquetOutputSet outputs;
+    char error[256] = "";
+    status = writer.Write(resourceType, JsonArray, arrayPatientData.c_str(), static_cast<int>(arrayPatientData.size()), &outputs, error);
+    EXPECT_EQ(0, status);
+    EXPECT_EQ("", std::string(error));
+    EXPECT_EQ(1, outputs.Count());
+
+    const string* key;
+    shared_ptr<arrow::Buffer> buffer;
+    EXPECT_TRUE(outputs.Get(0, &key, &buffer));
+    EXPECT_EQ(resourceType, *key);
+    EXPECT_TRUE(expected_table->Equals(*parse_buffer_to_table(buffer)));
+
+    ParquetOutputSet invalidOutputs;
+    string invalidArrayData = "[" + PatientData + "," + PatientData;
+    status = writer.Write(resourceType, JsonArray, invalidArrayData.c_str(), static_cast<int>(invalidArrayData.size()), &invalidOutputs, error);
+    EXPECT_EQ(10001, status);
+    EXPECT_EQ(0, invalidOutputs.Count());
+
+    // A NUL byte outside of strings is rejected rather than scanned forever, found by ParquetWriterFuzzer.
+    string nulArrayData = "[" + PatientData + ",";
+    nulArrayData += '\0';
+    nulArrayData += "]";
+    status = writer.Write(resourceType, JsonArray, nulArrayData.c_str(), static_cast<int>(nulArrayData.size()), &invalidOutputs, error);
+    EXPECT_EQ(10001, status);
+    EXPECT_EQ(0, invalidOutputs.Count());
+}
+
+TEST (ParquetWriter, WriteBundlePatient)
+{
+    string exampleSchema = read_file_text(TestDataDir + "patient_example_schema.json");
+    string batchPatientData = read_file_text(TestDataDir + "Patient.ndjson");
+    ParquetWriter writer;
+    EXPECT_EQ(0, writer.RegisterSchema("Patient", exampleSchema));
+    EXPECT_EQ(0, writer.RegisterSchema("Person", exampleSchema));
+
+    // Every other patient is relabeled as a Person, so the bundle routes to two schema keys.
+    string bundleData = R"({"resourceType":"Bundle","type":"searchset","total":7,"entry":[)";
+    istringstream lines(batchPatientData);
+    string line;
+    int lineIndex = 0;
+    while (getline(lines, line))
+    {
+        if (!line.empty())
+        {
+            if (lineIndex++ % 2 == 1)
+            {
+                line.replace(line.find("Patient"), 7, "Person");
+            }
+
+            bundleData += R"({"fullUrl":"urn:uuid:)" + to_string(lineIndex) + R"(","resource":)" + line + R"(,"search":{"mode":"match"}},)";
+        }
+    }
+    bundleData += R"({"fullUrl":"urn:uuid:deleted","request":{"method":"DELETE","url":"Patient/8"}}]})";
+
+    ParquetOutputSet outputs;
+    char error[256] = "";
+    int status = writer.Write("", Bundle, bundleData.c_str(), static_cast<int>(bundleData.size()), &outputs, error);
+    EXPECT_EQ(0, status);
+    EXPECT_EQ("", std::string(error));
+    EXPECT_EQ(2, outputs.Count());
+
+    const string* key;
+    shared_ptr<arrow::Buffer> buffer;
+    EXPECT_TRUE(outputs.Get(0, &key, &buffer));
+    EXPECT_EQ("Patient", *key);
+    const auto patientTable = parse_buffer_to_table(buffer);
+    EXPECT_EQ(4, patientTable->num_rows());
+    EXPECT_TRUE(patientTable->schema()->Equals(get_patient_schema(), true));
+
+    EXPECT_TRUE(outputs.Get(1, &key, &buffer));
+    EXPECT_EQ("Person", *key);
+    EXPECT_EQ(3, parse_buffer_to_table(buffer)->num_rows());
+
+    // Resource types without a schema are skipped, the other types of the bundle are still converted.
+    ParquetOutputSet mixedOutputs;
+    string mixedBundleData = R"({"resourceType":"Bundle","type":"searchset","entry":[{"resource":)" + PatientData
+        + R"(},{"resource":{"resourceType":"OperationOutcome","issue":[{"severity":"information","code":"informational"}]},"search":{"mode":"outcome"}}]})";
+    status = writer.Write("", Bundle, mixedBundleData.c_str(), static_cast<int>(mixedBundleData.size()), &mixedOutputs, error);
+    EXPECT_EQ(0, status);
+    EXPECT_EQ(1, mixedOutputs.Count());
+    EXPECT_TRUE(mixedOutputs.Get(0, &key, &buffer));
+    EXPECT_EQ("Patient", *key);
+    EXPECT_TRUE(get_expected_patient_table()->Equals(*parse_buffer_to_table(buffer)));
+    EXPECT_EQ(1, mixedOutputs.SkippedCount());
+    EXPECT_TRUE(mixedOutputs.GetSkipped(0, &key));
+    EXPECT_EQ("OperationOutcome", *key);
+
+    ParquetOutputSet unknownOutputs;
+    string unknownBundleData = R"({"resourceType":"Bundle","entry":[{"resource":{"resourceType":"Observation","id":"1"}}]})";
+    status = writer.Write("", Bundle, unknownBundleData.c_str(), static_cast<int>(unknownBundleData.size()), &unknownOutputs, error);
+    EXPECT_EQ(0, status);
+    EXPECT_EQ(0, unknownOutputs.Count());
+    EXPECT_EQ(1, unknownOutputs.SkippedCount());
+
+    string notBundleData = PatientData;
+    status = writer.Write("", Bundle, notBundleData.c_str(), static_cast<int>(notBundleData.size()), &unknownOutputs, error);
+    EXPECT_EQ(10001, status);
+    EXPECT_NE("", std::string(error));
+}
+
+TEST (ParquetWriter, WriteMixedNdjsonPatient)
+{
+    string exampleSchema = read_file_text(TestDataDir + "patient_example_schema.json");
+    string batchPatientData = read_file_text(TestDataDir + "Patient.ndjson");
+    ParquetWriter writer;
+    EXPECT_EQ(0, writer.RegisterSchema("Patient", exampleSchema));
+    EXPECT_EQ(0, writer.RegisterSchema("Person", exampleSchema));
+
+    // Every other patient is relabeled as a Person and the lines of each type are also converted separately.
+    string mixedData;
+    map<string, string> expectedData;
+    istringstream lines(batchPatientData);
+    string line;
+    int lineIndex = 0;
+    while (getline(lines, line))
+    {
+        if (!line.empty())
+        {
+            if (lineIndex++ % 2 == 1)
+            {
+                line.replace(line.find("Patient"), 7, "Person");
+            }
+
+            mixedData += line + "\n\n";
+            expectedData[lineIndex % 2 == 0 ? "Person" : "Patient"] += line + "\n";
+        }
+    }
+
+    ParquetOutputSet outputs;
+    char error[256] = "";
+    int status = writer.Write("", MixedNdjson, mixedData.c_str(), static_cast<int>(mixedData.size()), &outputs, error);
+    EXPECT_EQ(0, status);
+    EXPECT_EQ("", std::string(error));
+    EXPECT_EQ(2, outputs.Count());
+
+    int outputIndex = 0;
+    for (const auto& expected : expectedData)
+    {
+        byte* outputData = nullptr;
+        int outputLength = 0;
+        status = writer.Write(expected.first, expected.second.c_str(), static_cast<int>(expected.second.size()), &outputData, &outputLength);
+        EXPECT_EQ(0, status);
+        const auto expected_table = parse_buffer_to_table(arrow::Buffer::FromString(string(reinterpret_cast<char*>(outputData), outputLength)));
+        writer.ReleaseOutput(outputData);
+
+        const string* key;
+        shared_ptr<arrow::Buffer> buffer;
+        EXPECT_TRUE(outputs.Get(outputIndex++, &key, &buffer));
+        EXPECT_EQ(expected.first, *key);
+        EXPECT_TRUE(expected_table->Equals(*parse_buffer_to_table(buffer)));
+    }
+
+    ParquetOutputSet invalidOutputs;
+    string unknownData = mixedData + R"({"resourceType":"Observation","id":"1"})";
+    status = writer.Write("", MixedNdjson, unknownData.c_str(), static_cast<int>(unknownData.size()), &invalidOutputs, error);
+    EXPECT_EQ(0, status);
+    EXPECT_EQ(2, invalidOutputs.Count());
+    EXPECT_EQ(1, invalidOutputs.SkippedCount());
+
+    ParquetOutputSet untypedOutputs;
+    string untypedData = mixedData + R"({"id":"1"})";
+    status = writer.Write("", MixedNdjson, untypedData.c_str(), static_cast<int>(untypedData.size()), &untypedOutputs, error);
+    EXPECT_EQ(10001, status);
+    EXPECT_EQ(0, untypedOutputs.Count());
+}
+
+TEST (ParquetWriter, WriteMixedNdjsonWithBusyExecutor)
+{
+    string exampleSchema = read_file_text(TestDataDir + "patient_example_schema.json");
+    AsyncConversionState state;
+    state.releaseCallbacks = false;
+    ParquetWriter writer;
+    EXPECT_EQ(0, writer.RegisterSchema("Patient", exampleSchema));
+
+    // Occupy every executor thread with an async job blocked in its callback.
+    char error[256] = "";
+    for (int i = 0; i < ParquetOptions::AsyncThreadCount; i++)
+    {
+        long long jobId = 0;
+        EXPECT_EQ(0, writer.WriteAsync("Patient", PatientData.c_str(), static_cast<int>(PatientData.size()), RecordAsyncConversion, &state, &jobId, error));
+    }
+
+    {
+        unique_lock<mutex> lock(state.stateMutex);
+        state.stateChanged.wait(lock, [&state] { return state.runningCallbacks == ParquetOptions::AsyncThreadCount; });
+    }
+
+    // More resource types than executor threads, the calling thread converts them all while the executor is busy.
+    string mixedData;
+    const int typeCount = ParquetOptions::AsyncThreadCount + 2;
+    for (int i = 0; i < typeCount; i++)
+    {
+        const string resourceType = "Patient" + to_string(i);
+        EXPECT_EQ(0, writer.RegisterSchema(resourceType, exampleSchema));
+        string line = PatientData;
+        line.replace(line.find("Patient"), 7, resourceType);
+        mixedData += line + "\n";
+    }
+
+    mixedData += R"({"resourceType":"OperationOutcome","issue":[]})";
+    ParquetOutputSet outputs;
+    int status = writer.Write("", MixedNdjson, mixedData.c_str(), static_cast<int>(mixedData.size()), &outputs, error);
+    EXPECT_EQ(0, status);
+    EXPECT_EQ(typeCount, outputs.Count());
+    EXPECT_EQ(1, outputs.SkippedCount());
+    for (int i = 0; i < outputs.Count(); i++)
+    {
+        const string* key;
+        shared_ptr<arrow::Buffer> buffer;
+        EXPECT_TRUE(outputs.Get(i, &key, &buffer));
+        EXPECT_EQ("Patient" + to_string(i), *key);
+        EXPECT_EQ(1, parse_buffer_to_table(buffer)->num_rows());
+    }
+
+    {
+        lock_guard<mutex> lock(state.stateMutex);
+        state.releaseCallbacks = true;
+        state.stateChanged.notify_all();
+    }
+}
+
+TEST (ParquetWriter, WriteWithSchemaColumnEncodings)
+{
+    string resourceType = "Observation";
+    string observationSchema = R"({"Name": "Observation", "Type": "Observation", "IsRepeated": false, "SubNodes": {
+        "id": {"Name": "id", "Type": "id", "IsLeaf": true, "IsRepeated": false},
+        "valueInteger": {"Name": "valueInteger", "Type": "integer", "IsLeaf": true, "IsRepeated": false},
+        "valueDecimal": {"Name": "valueDecimal", "Type": "decimal", "IsLeaf": true, "IsRepeated": false}}})";
+    ParquetWriter writer;
+    int schemaStatus = writer.RegisterSchema(resourceType, observationSchema);
+    EXPECT_EQ(0, schemaStatus);
+
+    string observationData;
+    for (int i = 0; i < 100; i++)
+    {
+        observationData += R"({"id":")" + to_string(i) + R"(","valueInteger":)" + to_string(i * 3) + R"(,"valueDecimal":)" + to_string(i * 0.5) + "}\n";
+    }
+
+    byte* outputData = nullptr;
+    int outputLength = 0;
+    int status = writer.Write(resourceType, observationData.c_str(), static_cast<int>(observationData.size()), &outputData, &outputLength);
+    EXPECT_EQ(0, status);
+
+    const auto buffer = arrow::Buffer::FromString(string(reinterpret_cast<char*>(outputData), outputLength));
+    writer.ReleaseOutput(outputData);
+    const auto metadata = parquet::ParquetFileReader::Open(std::make_shared<arrow::io::BufferReader>(buffer))->metadata();
+    const auto rowGroup = metadata->RowGroup(0);
+    for (int i = 0; i < rowGroup->num_columns(); i++)
+    {
+        const auto column = rowGroup->ColumnChunk(i);
+        const auto encodings = column->encodings();
+        const string path = column->path_in_schema()->ToDotString();
+        if (path == "valueInteger")
+        {
+            EXPECT_NE(encodings.end(), find(encodings.begin(), encodings.end(), parquet::Encoding::DELTA_BINARY_PACKED));
+        }
+        else if (path == "valueDecimal")
+        {
+            EXPECT_NE(encodings.end(), find(encodings.begin(), encodings.end(), parquet::Encoding::BYTE_STREAM_SPLIT));
+        }
+        else
+        {
+            EXPECT_NE(encodings.end(), find(encodings.begin(), encodings.end(), parquet::Encoding::RLE_DICTIONARY));
+        }
+    }
+
+    const auto table = parse_buffer_to_table(buffer);
+    EXPECT_EQ(100, table->num_rows());
+}
+
+TEST (ParquetWriter, WriteWithEncodingHints)
+{
+    // Encodings that only newer arrow versions can write fall back to PLAIN hints on older ones.
+#if ARROW_VERSION_MAJOR >= 12
+    const string stringHint = "DELTA_BYTE_ARRAY";
+    const string booleanHint = "RLE";
+#else
+    const string stringHint = "PLAIN";
+    const string booleanHint = "PLAIN";
+#endif
+    const map<string, string> hints { { "id", "PLAIN" }, { "status", stringHint }, { "valueInteger", "DELTA_BINARY_PACKED" }, { "valueDecimal", "BYTE_STREAM_SPLIT" }, { "valueBoolean", booleanHint } };
+    const map<string, string> types { { "id", "id" }, { "status", "code" }, { "valueInteger", "integer" }, { "valueDecimal", "decimal" }, { "valueBoolean", "boolean" } };
+    string observationSchema = R"({"Name": "Observation", "Type": "Observation", "IsRepeated": false, "SubNodes": {)";
+    string plainSchema = observationSchema;
+    for (const auto& hint : hints)
+    {
+        const string leaf = (hint.first == hints.begin()->first ? "" : ",") + string("\"") + hint.first + R"(": {"Name": ")" + hint.first + R"(", "Type": ")"
+            + types.at(hint.first) + R"(", "IsLeaf": true, "IsRepeated": false)";
+        observationSchema += leaf + R"(, "Encoding": ")" + hint.second + "\"}";
+        plainSchema += leaf + "}";
+    }
+
+    observationSchema += "}}";
+    plainSchema += "}}";
+    ParquetWriter writer;
+    EXPECT_EQ(0, writer.RegisterSchema("Observation", observationSchema));
+    EXPECT_EQ(0, writer.RegisterSchema("PlainObservation", plainSchema));
+
+    string observationData;
+    for (int i = 0; i < 100; i++)
+    {
+        observationData += R"({"id":")" + to_string(i) + R"(","status":")" + (i % 3 == 0 ? "final" : "preliminary") + R"(","valueInteger":)" + to_string(i * 3)
+            + R"(,"valueDecimal":)" + to_string(i * 0.5) + R"(,"valueBoolean":)" + (i % 2 == 0 ? "true" : "false") + "}\n";
+    }
+
+    byte* outputData = nullptr;
+    int outputLength = 0;
+    char error[256] = "";
+    int status = writer.Write("Observation", observationData.c_str(), static_cast<int>(observationData.size()), &outputData, &outputLength, error);
+    ASSERT_EQ(0, status) << error;
+    const auto buffer = arrow::Buffer::FromString(string(reinterpret_cast<char*>(outputData), outputLength));
+    writer.ReleaseOutput(outputData);
+
+    // The row group metadata points into the file metadata, which has to outlive it.
+    const auto metadata = parquet::ParquetFileReader::Open(std::make_shared<arrow::io::BufferReader>(buffer))->metadata();
+    const auto rowGroup = metadata->RowGroup(0);
+    for (int i = 0; i < rowGroup->num_columns(); i++)
+    {
+        const auto column = rowGroup->ColumnChunk(i);
+        const auto encodings = column->encodings();
+        const string hint = hints.at(column->path_in_schema()->ToDotString());
+        EXPECT_NE(encodings.end(), find_if(encodings.begin(), encodings.end(), [&hint](parquet::Encoding::type encoding) { return parquet::EncodingToString(encoding) == hint; })) << hint;
+    }
+
+    // The values read back are the same as without hints.
+    status = writer.Write("PlainObservation", observationData.c_str(), static_cast<int>(observationData.size()), &outputData, &outputLength, error);
+    ASSERT_EQ(0, status) << error;
+    const auto expected_table = parse_buffer_to_table(arrow::Buffer::FromString(string(reinterpret_cast<char*>(outputData), outputLength)));
+    writer.ReleaseOutput(outputData);
+    const auto table = parse_buffer_to_table(buffer);
+    EXPECT_EQ(100, table->num_rows());
+    EXPECT_TRUE(expected_table->Equals(*table));
+}
+
+TEST (ParquetWriter, WriteFlattenedPatient)
+{
+    string resourceType = "Patient";
+    string exampleSchema = read_file_text(TestDataDir + "patient_example_schema.json");
+    string batchPatientData = read_file_text(TestDataDir + "Patient.ndjson");
+    ParquetWriter writer;
+    int schemaStatus = writer.RegisterSchema(resourceType, exampleSchema);
+    EXPECT_EQ(0, schemaStatus);
+
+    char error[256] = "";
+    EXPECT_EQ(11002, writer.SetFlattenedPaths("Observation", { "component" }, error));
+    EXPECT_EQ(11001, writer.SetFlattenedPaths(resourceType, { "gender" }, error));
+    EXPECT_EQ(11001, writer.SetFlattenedPaths(resourceType, { "name", "name.given" }, error));
+    EXPECT_EQ(11001, writer.SetFlattenedPaths(resourceType, { "name.use", "name.family", "name.given" }, error));
+    EXPECT_EQ(0, writer.SetFlattenedPaths(resourceType, { "name.given" }, error));
+
+    ParquetOutputSet outputs;
+    int status = writer.Write(resourceType, Ndjson, batchPatientData.c_str(), static_cast<int>(batchPatientData.size()), &outputs, error);
+    EXPECT_EQ(0, status);
+    EXPECT_EQ(2, outputs.Count());
+
+    // The parent keeps the name struct without the promoted given names.
+    const string* key;
+    shared_ptr<arrow::Buffer> buffer;
+    EXPECT_TRUE(outputs.Get(0, &key, &buffer));
+    EXPECT_EQ(resourceType, *key);
+    const auto parentTable = parse_buffer_to_table(buffer);
+    EXPECT_EQ(7, parentTable->num_rows());
+    const auto nameType = static_pointer_cast<arrow::ListType>(parentTable->schema()->GetFieldByName("name")->type());
+    EXPECT_EQ(nullptr, static_pointer_cast<arrow::StructType>(nameType->value_type())->GetFieldByName("given"));
+    EXPECT_NE(nullptr, static_pointer_cast<arrow::StructType>(nameType->value_type())->GetFieldByName("family"));
+
+    // Each patient has the given names Peter, James and Jim across its two names.
+    EXPECT_TRUE(outputs.Get(1, &key, &buffer));
+    EXPECT_EQ("Patient_name_given", *key);
+    const auto childTable = parse_buffer_to_table(buffer);
+    EXPECT_EQ(21, childTable->num_rows());
+    EXPECT_EQ("resourceId: string\nname_index: int32 not null\ngiven_index: int32 not null\ngiven: string", childTable->schema()->ToString());
+    const auto resourceIds = static_pointer_cast<arrow::StringArray>(childTable->column(0)->chunk(0));
+    const auto nameIndexes = static_pointer_cast<arrow::Int32Array>(childTable->column(1)->chunk(0));
+    const auto givenIndexes = static_pointer_cast<arrow::Int32Array>(childTable->column(2)->chunk(0));
+    const auto givenNames = static_pointer_cast<arrow::StringArray>(childTable->column(3)->chunk(0));
+    EXPECT_EQ("1", resourceIds->GetString(0));
+    EXPECT_EQ("Peter", givenNames->GetString(0));
+    EXPECT_EQ("Jim", givenNames->GetString(2));
+    EXPECT_EQ(1, nameIndexes->Value(2));
+    EXPECT_EQ(0, givenIndexes->Value(2));
+    EXPECT_EQ("2", resourceIds->GetString(3));
+
+    // A promoted list of structs is split into one column per struct field.
+    EXPECT_EQ(0, writer.SetFlattenedPaths(resourceType, { "name" }, error));
+    ParquetOutputSet nameOutputs;
+    status = writer.Write(resourceType, Ndjson, batchPatientData.c_str(), static_cast<int>(batchPatientData.size()), &nameOutputs, error);
+    EXPECT_EQ(0, status);
+    EXPECT_TRUE(nameOutputs.Get(0, &key, &buffer));
+    EXPECT_EQ(nullptr, parse_buffer_to_table(buffer)->schema()->GetFieldByName("name"));
+    EXPECT_TRUE(nameOutputs.Get(1, &key, &buffer));
+    EXPECT_EQ("Patient_name", *key);
+    const auto nameTable = parse_buffer_to_table(buffer);
+    EXPECT_EQ(14, nameTable->num_rows());
+    EXPECT_NE(nullptr, nameTable->schema()->GetFieldByName("name_index"));
+    EXPECT_NE(nullptr, nameTable->schema()->GetFieldByName("family"));
+    EXPECT_NE(nullptr, nameTable->schema()->GetFieldByName("given"));
+}
+
+TEST (ParquetWriter, RejoinFlattenedPatient)
+{
+    string resourceType = "Patient";
+    string exampleSchema = read_file_text(TestDataDir + "patient_example_schema.json");
+    string batchPatientData = read_file_text(TestDataDir + "Patient.ndjson");
+    ParquetWriter writer;
+    int schemaStatus = writer.RegisterSchema(resourceType, exampleSchema);
+    EXPECT_EQ(0, schemaStatus);
+
+    char error[256] = "";
+    ParquetOutputSet expectedOutputs;
+    int status = writer.Write(resourceType, Ndjson, batchPatientData.c_str(), static_cast<int>(batchPatientData.size()), &expectedOutputs, error);
+    EXPECT_EQ(0, status);
+    const string* key;
+    shared_ptr<arrow::Buffer> buffer;
+    EXPECT_TRUE(expectedOutputs.Get(0, &key, &buffer));
+    const auto expectedTable = parse_buffer_to_table(buffer)->CombineChunks().ValueOrDie();
+
+    EXPECT_EQ(0, writer.SetFlattenedPaths(resourceType, { "name.given" }, error));
+    ParquetOutputSet outputs;
+    status = writer.Write(resourceType, Ndjson, batchPatientData.c_str(), static_cast<int>(batchPatientData.size()), &outputs, error);
+    EXPECT_EQ(0, status);
+    EXPECT_TRUE(outputs.Get(0, &key, &buffer));
+    const auto parentTable = parse_buffer_to_table(buffer)->CombineChunks().ValueOrDie();
+    EXPECT_TRUE(outputs.Get(1, &key, &buffer));
+    const auto childTable = parse_buffer_to_table(buffer)->CombineChunks().ValueOrDie();
+
+    // Each child row joins its resource by id and its name element by name_index, and finds the same given name the unflattened table has there.
+    const auto expectedNames = static_pointer_cast<arrow::ListArray>(expectedTable->GetColumnByName("name")->chunk(0));
+    const auto parentIds = static_pointer_cast<arrow::StringArray>(parentTable->GetColumnByName("id")->chunk(0));
+    const auto parentNames = static_pointer_cast<arrow::ListArray>(parentTable->GetColumnByName("name")->chunk(0));
+    const auto resourceIds = static_pointer_cast<arrow::StringArray>(childTable->GetColumnByName(ResourceIdColumnName)->chunk(0));
+    const auto nameIndexes = static_pointer_cast<arrow::Int32Array>(childTable->GetColumnByName("name_index")->chunk(0));
+    const auto givenIndexes = static_pointer_cast<arrow::Int32Array>(childTable->GetColumnByName("given_index")->chunk(0));
+    const auto givenNames = static_pointer_cast<arrow::StringArray>(childTable->GetColumnByName("given")->chunk(0));
+    int64_t expectedGivenCount = 0;
+    for (int64_t row = 0; row < expectedNames->length(); row++)
+    {
+        const auto names = static_pointer_cast<arrow::StructArray>(expectedNames->value_slice(row));
+        const auto givenLists = static_pointer_cast<arrow::ListArray>(names->GetFieldByName("given"));
+        for (int64_t i = 0; i < givenLists->length(); i++)
+        {
+            expectedGivenCount += givenLists->value_length(i);
+        }
+    }
+
+    EXPECT_EQ(expectedGivenCount, childTable->num_rows());
+    for (int64_t i = 0; i < childTable->num_rows(); i++)
+    {
+        int64_t row = 0;
+        while (row < parentIds->length() && parentIds->GetView(row) != resourceIds->GetView(i))
+        {
+            row++;
+        }
+
+        ASSERT_LT(row, parentIds->length());
+        ASSERT_LT(nameIndexes->Value(i), parentNames->value_length(row));
+        const auto parentName = static_pointer_cast<arrow::StructArray>(parentNames->value_slice(row));
+        const auto expectedName = static_pointer_cast<arrow::StructArray>(expectedNames->value_slice(row));
+        EXPECT_TRUE(parentName->GetFieldByName("family")->RangeEquals(nameIndexes->Value(i), nameIndexes->Value(i) + 1, nameIndexes->Value(i), expectedName->GetFieldByName("family")));
+
+        const auto expectedGiven = static_pointer_cast<arrow::ListArray>(expectedName->GetFieldByName("given"));
+        const auto expectedGivenNames = static_pointer_cast<arrow::StringArray>(expectedGiven->value_slice(nameIndexes->Value(i)));
+        ASSERT_LT(givenIndexes->Value(i), expectedGivenNames->length());
+        EXPECT_EQ(expectedGivenNames->GetString(givenIndexes->Value(i)), givenNames->GetString(i));
+    }
+}
+
+arrow::Status OpenParquetBuffer(const shared_ptr<arrow::Buffer>& buffer, const parquet::ReaderProperties& readerProperties, unique_ptr<parquet::arrow::FileReader>* reader)
+{
+    const auto bufferReader = make_shared<arrow::io::BufferReader>(buffer);
+    parquet::arrow::FileReaderBuilder readerBuilder;
+    ARROW_RETURN_NOT_OK(readerBuilder.Open(bufferReader, readerProperties));
+    return readerBuilder.Build(reader);
+}
+
+parquet::ReaderProperties GetDecryptionReaderProperties(const arrow::Schema& schema, const EncryptionKeys& keys, const string& flattenedPath)
+{
+    parquet::ReaderProperties readerProperties = parquet::default_reader_properties();
+    readerProperties.file_decryption_properties(BuildDecryptionProperties(schema, keys, flattenedPath));
+    return readerProperties;
+}
+
+TEST (ParquetWriter, WriteEncryptedPatient)
+{
+    string resourceType = "Patient";
+    string exampleSchema = read_file_text(TestDataDir + "patient_example_schema.json");
+    string batchPatientData = read_file_text(TestDataDir + "Patient.ndjson");
+    ParquetWriter writer;
+    int schemaStatus = writer.RegisterSchema(resourceType, exampleSchema);
+    EXPECT_EQ(0, schemaStatus);
+
+    byte* outputData = nullptr;
+    int outputLength = 0;
+    int status = writer.Write(resourceType, batchPatientData.c_str(), static_cast<int>(batchPatientData.size()), &outputData, &outputLength);
+    EXPECT_EQ(0, status);
+    const auto expected_table = parse_buffer_to_table(arrow::Buffer::FromString(string(reinterpret_cast<char*>(outputData), outputLength)));
+    writer.ReleaseOutput(outputData);
+
+    EncryptionKeys keys;
+    keys.footerKey = "0123456789abcdef";
+    keys.columnKeys.push_back(make_pair("name", "fedcba9876543210"));
+    char error[256] = "";
+    EXPECT_EQ(11002, writer.SetEncryptionKeys("Observation", keys, error));
+    EXPECT_EQ(0, writer.SetEncryptionKeys(resourceType, keys, error));
+
+    status = writer.Write(resourceType, batchPatientData.c_str(), static_cast<int>(batchPatientData.size()), &outputData, &outputLength);
+    EXPECT_EQ(0, status);
+    const auto buffer = arrow::Buffer::FromString(string(reinterpret_cast<char*>(outputData), outputLength));
+    writer.ReleaseOutput(outputData);
+
+    // The footer is encrypted, so the file can't be opened without keys.
+    unique_ptr<parquet::arrow::FileReader> reader;
+    EXPECT_FALSE(OpenParquetBuffer(buffer, parquet::default_reader_properties(), &reader).ok());
+
+    ASSERT_TRUE(OpenParquetBuffer(buffer, GetDecryptionReaderProperties(*expected_table->schema(), keys, ""), &reader).ok());
+    shared_ptr<arrow::Table> table;
+    ASSERT_TRUE(reader->ReadTable(&table).ok());
+    EXPECT_TRUE(expected_table->Equals(*table));
+
+    // The footer key alone reads every leaf column but those of name. A failed read leaves the reader unusable, so each column gets a new reader.
+    EncryptionKeys footerKeys;
+    footerKeys.footerKey = keys.footerKey;
+    const auto metadata = reader->parquet_reader()->metadata();
+    const auto parquetSchema = metadata->schema();
+    for (int i = 0; i < parquetSchema->num_columns(); i++)
+    {
+        const string columnPath = parquetSchema->Column(i)->path()->ToDotString();
+        ASSERT_TRUE(OpenParquetBuffer(buffer, GetDecryptionReaderProperties(*expected_table->schema(), footerKeys, ""), &reader).ok());
+        EXPECT_EQ(columnPath.compare(0, 5, "name.") != 0, reader->ReadTable({ i }, &table).ok()) << columnPath;
+    }
+
+    // Child tables of promoted paths under a column prefix use the key of the prefix, except for their resourceId and ordinal columns.
+    EXPECT_EQ(0, writer.SetFlattenedPaths(resourceType, { "name" }, error));
+    ParquetOutputSet outputs;
+    status = writer.Write(resourceType, Ndjson, batchPatientData.c_str(), static_cast<int>(batchPatientData.size()), &outputs, error);
+    EXPECT_EQ(0, status);
+    EXPECT_EQ(2, outputs.Count());
+
+    const string* key;
+    shared_ptr<arrow::Buffer> childBuffer;
+    EXPECT_TRUE(outputs.Get(1, &key, &childBuffer));
+    ASSERT_TRUE(OpenParquetBuffer(childBuffer, GetDecryptionReaderProperties(arrow::Schema({}), footerKeys, ""), &reader).ok());
+    shared_ptr<arrow::Schema> childSchema;
+    ASSERT_TRUE(reader->GetSchema(&childSchema).ok());
+    const auto childMetadata = reader->parquet_reader()->metadata();
+    const auto childParquetSchema = childMetadata->schema();
+    for (int i = 0; i < childParquetSchema->num_columns(); i++)
+    {
+        const string columnPath = childParquetSchema->Column(i)->path()->ToDotString();
+        ASSERT_TRUE(OpenParquetBuffer(childBuffer, GetDecryptionReaderProperties(arrow::Schema({}), footerKeys, ""), &reader).ok());
+        EXPECT_EQ(IsChildKeyColumn("name", columnPath), reader->ReadTable({ i }, &table).ok()) << columnPath;
+    }
+
+    ASSERT_TRUE(OpenParquetBuffer(childBuffer, GetDecryptionReaderProperties(*childSchema, keys, "name"), &reader).ok());
+    ASSERT_TRUE(reader->ReadTable(&table).ok());
+    EXPECT_EQ(14, table->num_rows());
+
+    // Invalid key lengths, unknown or overlapping prefixes are rejected.
+    EncryptionKeys invalidKeys;
+    invalidKeys.footerKey = "short";
+    EXPECT_EQ(14001, writer.SetEncryptionKeys(resourceType, invalidKeys, error));
+    invalidKeys.footerKey = keys.footerKey;
+    invalidKeys.columnKeys.push_back(make_pair("identifier", keys.footerKey));
+    EXPECT_EQ(14001, writer.SetEncryptionKeys(resourceType, invalidKeys, error));
+    invalidKeys.columnKeys = { make_pair("name", keys.footerKey), make_pair("name.given", keys.footerKey) };
+    EXPECT_EQ(14001, writer.SetEncryptionKeys(resourceType, invalidKeys, error));
+
+    // Clearing the keys writes plain parquet again.
+    EXPECT_EQ(0, writer.SetEncryptionKeys(resourceType, EncryptionKeys(), error));
+    status = writer.Write(resourceType, batchPatientData.c_str(), static_cast<int>(batchPatientData.size()), &outputData, &outputLength);
+    EXPECT_EQ(0, status);
+    EXPECT_TRUE(expected_table->Equals(*parse_buffer_to_table(arrow::Buffer::FromString(string(reinterpret_cast<char*>(outputData), outputLength)))));
+    writer.ReleaseOutput(outputData);
+}
+
+TEST (ParquetWriter, WriteWithPageChecksum)
+{
+    string resourceType = "Patient";
+    string exampleSchema = read_file_text(TestDataDir + "patient_example_schema.json");
+    string batchPatientData = read_file_text(TestDataDir + "Patient.ndjson");
+    ParquetWriter writer;
+    int schemaStatus = writer.RegisterSchema(resourceType, exampleSchema);
+    EXPECT_EQ(0, schemaStatus);
+
+    char error[256] = "";
+#if ARROW_VERSION_MAJOR >= 13
+    EXPECT_EQ(0, writer.SetPageChecksum(true, error));
+
+    byte* outputData = nullptr;
+    int outputLength = 0;
+    int status = writer.Write(resourceType, batchPatientData.c_str(), static_cast<int>(batchPatientData.size()), &outputData, &outputLength);
+    EXPECT_EQ(0, status);
+    string output(reinterpret_cast<char*>(outputData), outputLength);
+    writer.ReleaseOutput(outputData);
+
+    parquet::ReaderProperties readerProperties = parquet::default_reader_properties();
+    readerProperties.set_page_checksum_verification(true);
+    unique_ptr<parquet::arrow::FileReader> reader;
+    ASSERT_TRUE(OpenParquetBuffer(arrow::Buffer::FromString(output), readerProperties, &reader).ok());
+    shared_ptr<arrow::Table> table;
+    ASSERT_TRUE(reader->ReadTable(&table).ok());
+    EXPECT_EQ(7, table->num_rows());
+
+    // Corrupt the last byte of the first column chunk, which is inside its last page.
+    const auto columnChunk = reader->parquet_reader()->metadata()->RowGroup(0)->ColumnChunk(0);
+    const int64_t chunkStart = columnChunk->has_dictionary_page() ? columnChunk->dictionary_page_offset() : columnChunk->data_page_offset();
+    output[chunkStart + columnChunk->total_compressed_size() - 1] ^= 0xFF;
+    ASSERT_TRUE(OpenParquetBuffer(arrow::Buffer::FromString(output), readerProperties, &reader).ok());
+    shared_ptr<arrow::ChunkedArray> column;
+    const auto readStatus = reader->ReadColumn(0, &column);
+    EXPECT_FALSE(readStatus.ok());
+    EXPECT_NE(string::npos, readStatus.ToString().find("CRC"));
+#else
+    EXPECT_EQ(14002, writer.SetPageChecksum(true, error));
+#endif
+    EXPECT_EQ(0, writer.SetPageChecksum(false, error));
+}
+
+TEST (ParquetWriter, RecommendBatchSizeFromStatistics)
+{
+    string resourceType = "Patient";
+    string exampleSchema = read_file_text(TestDataDir + "patient_example_schema.json");
+    string batchPatientData = read_file_text(TestDataDir + "Patient.ndjson");
+    ParquetWriter writer;
+    int schemaStatus = writer.RegisterSchema(resourceType, exampleSchema);
+    EXPECT_EQ(0, schemaStatus);
+
+    ConversionStatistics statistics;
+    long long inputBytes = 0;
+    long long rows = 0;
+    EXPECT_EQ(13001, writer.GetStatistics(resourceType, &statistics));
+    EXPECT_EQ(13001, writer.GetRecommendedBatchSize(resourceType, 1 << 20, 0, &inputBytes, &rows));
+
+    byte* outputData = nullptr;
+    int outputLength = 0;
+    int status = writer.Write(resourceType, batchPatientData.c_str(), static_cast<int>(batchPatientData.size()), &outputData, &outputLength);
+    EXPECT_EQ(0, status);
+    writer.ReleaseOutput(outputData);
+
+    EXPECT_EQ(0, writer.GetStatistics(resourceType, &statistics));
+    EXPECT_EQ(1, statistics.ConversionCount);
+    EXPECT_DOUBLE_EQ(static_cast<double>(batchPatientData.size()) / 7, statistics.InputBytesPerRow);
+    EXPECT_DOUBLE_EQ(static_cast<double>(outputLength) / 7, statistics.OutputBytesPerRow);
+
+    // Doubling the target output doubles the recommended batch.
+    long long largerInputBytes = 0;
+    long long largerRows = 0;
+    EXPECT_EQ(0, writer.GetRecommendedBatchSize(resourceType, 1 << 20, 0, &inputBytes, &rows));
+    EXPECT_EQ(0, writer.GetRecommendedBatchSize(resourceType, 1 << 21, 0, &largerInputBytes, &largerRows));
+    EXPECT_EQ(static_cast<long long>((1 << 20) / statistics.OutputBytesPerRow), rows);
+    EXPECT_NEAR(2 * rows, largerRows, 1);
+    EXPECT_NEAR(2 * inputBytes, largerInputBytes, 2 * statistics.InputBytesPerRow);
+}
+
+TEST (ConversionStatistics, RecommendPipelinedBatchSize)
+{
+    // 100 input bytes and 1e-4 seconds each of parsing and encoding per row.
+    ConversionStatisticsTracker tracker;
+    tracker.Record("Patient", 1000, 10, 10, 0.001, 0.001);
+
+    // Within the chunk size parsing and encoding add up, above it they overlap.
+    long long inputBytes = 0;
+    long long rows = 0;
+    EXPECT_TRUE(tracker.RecommendBatchSize("Patient", 1LL << 40, 1000, 1 << 20, &inputBytes, &rows));
+    EXPECT_NEAR(5000, rows, 1);
+    EXPECT_TRUE(tracker.RecommendBatchSize("Patient", 1LL << 40, 1000, 1 << 16, &inputBytes, &rows));
+    EXPECT_NEAR(10000, rows, 1);
+    EXPECT_NEAR(100 * rows, inputBytes, 100);
+}
+
+TEST (OutputBufferPool, GrowPooledOutputStream)
+{
+    OutputBufferPool pool;
+    string data(ParquetOptions::InitialOutputBufferSize + 10, 'a');
+    byte* outputData = nullptr;
+    int outputLength = 0;
+    {
+        PooledOutputStream outputStream(&pool);
+        EXPECT_TRUE(outputStream.Write(data.c_str(), static_cast<int64_t>(data.size())).ok());
+        EXPECT_EQ(static_cast<int64_t>(data.size()), outputStream.Tell().ValueOrDie());
+        EXPECT_TRUE(outputStream.Close().ok());
+        outputStream.Detach(&outputData, &outputLength);
+    }
+
+    EXPECT_EQ(data, string(reinterpret_cast<char*>(outputData), outputLength));
+    EXPECT_EQ(2, pool.AllocationCount());
+    EXPECT_TRUE(pool.ReleaseOutput(outputData));
+    EXPECT_FALSE(pool.ReleaseOutput(outputData));
+
+    // The next output is expected to be as large as the recent output.
+    EXPECT_EQ(static_cast<int64_t>(data.size()), pool.ExpectedOutputSize());
+}
+
+TEST (OutputBufferPool, ReuseAndCapIdleBuffers)
+{
+    OutputBufferPool pool;
+    int64_t capacity = 0;
+    byte* data = pool.Acquire(1000, &capacity);
+    EXPECT_EQ(1000, capacity);
+    EXPECT_TRUE(pool.Release(data));
+
+    // An idle buffer that fits the recent output is reused, new buffers get a quarter more room.
+    pool.RecordOutputSize(1000);
+    EXPECT_EQ(data, pool.Acquire(pool.ExpectedOutputSize(), &capacity));
+    EXPECT_EQ(1, pool.ReuseCount());
+    byte* largerData = pool.Acquire(pool.ExpectedOutputSize(), &capacity);
+    EXPECT_EQ(1250, capacity);
+    EXPECT_TRUE(pool.Release(data));
+    EXPECT_TRUE(pool.Release(largerData));
+
+    // A buffer above the idle byte cap is freed when it is released, the small idle buffers are kept.
+    byte* largeData = pool.Acquire(ParquetOptions::OutputBufferPoolMaxIdleBytes + 1, &capacity);
+    EXPECT_TRUE(pool.Release(largeData));
+    EXPECT_EQ(3, pool.AllocationCount());
+    pool.Release(pool.Acquire(ParquetOptions::OutputBufferPoolMaxIdleBytes, &capacity));
+    EXPECT_EQ(4, pool.AllocationCount());
+    EXPECT_EQ(data, pool.Acquire(1000, &capacity));
+    EXPECT_EQ(2, pool.ReuseCount());
+    EXPECT_TRUE(pool.Release(data));
+}
+
+static byte* DetachPooledOutput(OutputBufferPool* pool)
+{
+    byte* outputData = nullptr;
+    int outputLength = 0;
+    PooledOutputStream outputStream(pool);
+    EXPECT_TRUE(outputStream.Write("parquet", 7).ok());
+    outputStream.Detach(&outputData, &outputLength);
+    return outputData;
+}
+
+TEST (OutputBufferPool, FreedOutputIsNotReused)
+{
+    OutputBufferPool pool;
+    byte* outputData = DetachPooledOutput(&pool);
+    const byte* freedAddress = outputData;
+    OutputBufferPool::FreeOutput(outputData);
+
+    // A byte array allocated later at the same address is not taken for an output of the pool.
+    byte* otherData = const_cast<byte*>(freedAddress);
+    EXPECT_FALSE(pool.ReleaseOutput(otherData));
+
+    // Outputs that outlive their pool are freed when they are released to another pool.
+    OutputBufferPool* otherPool = new OutputBufferPool();
+    outputData = DetachPooledOutput(otherPool);
+    delete otherPool;
+    EXPECT_TRUE(pool.ReleaseOutput(outputData));
+
+    // Only outputs of the pool itself are reused.
+    outputData = DetachPooledOutput(&pool);
+    EXPECT_TRUE(pool.ReleaseOutput(outputData));
+    EXPECT_EQ(outputData, DetachPooledOutput(&pool));
+    EXPECT_EQ(1, pool.ReuseCount());
+    EXPECT_TRUE(pool.ReleaseOutput(outputData));
+}
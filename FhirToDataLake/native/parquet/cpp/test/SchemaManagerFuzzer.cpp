@@ -0,0 +1,17 @@
+#include "SchemaManager.h"
+#include <cstdint>
+using namespace std;
+
+// Feed arbitrary schema json to the schema manager, invalid schemas must be rejected with a status code.
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+    SchemaManager schemaManager;
+    const string schemaJson(reinterpret_cast<const char*>(data), size);
+    if (schemaManager.AddSchema("Fuzz", schemaJson) == 0)
+    {
+        schemaManager.GetSchema("Fuzz");
+        schemaManager.GetColumnEncodings("Fuzz");
+    }
+
+    return 0;
+}
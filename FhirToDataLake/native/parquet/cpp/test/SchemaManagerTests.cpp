@@ -1,6 +1,7 @@
 #include <gtest/gtest.h>
 #include <string>
 #include <json/json.h>
+#include <arrow/util/config.h>
 #include "SchemaManager.h"
 
 using namespace std;
@@ -84,6 +85,69 @@ TEST (SchemaTest, AddAndGetEmptyOrWhiteSpaceSchemaKey)
 }
 
 
+TEST (SchemaTest, GetColumnEncodings)
+{
+    SchemaManager schemaManager;
+    string mockSchema = R"({"Name": "Observation", "Type": "Observation", "IsRepeated": false, "SubNodes": {
+        "id": {"Name": "id", "Type": "id", "IsLeaf": true, "IsRepeated": false},
+        "component": {"Name": "component", "Type": "BackboneElement", "IsLeaf": false, "IsRepeated": true, "SubNodes": {
+            "valueInteger": {"Name": "valueInteger", "Type": "integer", "IsLeaf": true, "IsRepeated": false},
+            "valueDecimal": {"Name": "valueDecimal", "Type": "decimal", "IsLeaf": true, "IsRepeated": false}}},
+        "count": {"Name": "count", "Type": "positiveInt", "IsLeaf": true, "IsRepeated": false, "Encoding": "DICTIONARY"},
+        "issued": {"Name": "issued", "Type": "instant", "IsLeaf": true, "IsRepeated": false, "Encoding": "PLAIN"},
+        "flags": {"Name": "flags", "Type": "boolean", "IsLeaf": true, "IsRepeated": true}}})";
+    int status = schemaManager.AddSchema("Observation", mockSchema);
+    EXPECT_EQ(0, status);
+
+    const ColumnEncodings* encodings = schemaManager.GetColumnEncodings("Observation");
+    ASSERT_NE(nullptr, encodings);
+    ColumnEncodings expected {
+        { "component.list.element.valueDecimal", parquet::Encoding::BYTE_STREAM_SPLIT },
+        { "component.list.element.valueInteger", parquet::Encoding::DELTA_BINARY_PACKED },
+        { "issued", parquet::Encoding::PLAIN },
+    };
+
+    // Booleans are RLE encoded from arrow 12, earlier versions can't write RLE booleans.
+    if (ARROW_VERSION_MAJOR >= 12)
+    {
+        expected.insert(expected.end() - 1, make_pair("flags.list.element", parquet::Encoding::RLE));
+    }
+
+    EXPECT_EQ(expected, *encodings);
+    EXPECT_EQ(nullptr, schemaManager.GetColumnEncodings("Patient"));
+
+    string invalidHintSchema = R"({"Name": "Observation", "Type": "Observation", "IsRepeated": false, "SubNodes": {
+        "id": {"Name": "id", "Type": "id", "IsLeaf": true, "IsRepeated": false, "Encoding": "UNKNOWN"}}})";
+    EXPECT_EQ(11001, schemaManager.AddSchema("Invalid", invalidHintSchema));
+    EXPECT_EQ(nullptr, schemaManager.GetSchema("Invalid"));
+}
+
+TEST (SchemaTest, RejectUnsupportedEncodingHints)
+{
+    SchemaManager schemaManager;
+    auto hintSchema = [](const string& type, const string& encoding)
+    {
+        return R"({"Name": "Observation", "Type": "Observation", "IsRepeated": false, "SubNodes": {
+            "value": {"Name": "value", "Type": ")" + type + R"(", "IsLeaf": true, "IsRepeated": true, "Encoding": ")" + encoding + R"("}}})";
+    };
+
+    // Hints that don't fit the physical type of the leaf.
+    EXPECT_EQ(11001, schemaManager.AddSchema("Observation", hintSchema("string", "RLE")));
+    EXPECT_EQ(11001, schemaManager.AddSchema("Observation", hintSchema("string", "BYTE_STREAM_SPLIT")));
+    EXPECT_EQ(11001, schemaManager.AddSchema("Observation", hintSchema("decimal", "DELTA_BINARY_PACKED")));
+    EXPECT_EQ(11001, schemaManager.AddSchema("Observation", hintSchema("boolean", "DELTA_LENGTH_BYTE_ARRAY")));
+    EXPECT_EQ(nullptr, schemaManager.GetSchema("Observation"));
+
+    EXPECT_EQ(0, schemaManager.AddSchema("Observation", hintSchema("string", "PLAIN")));
+    EXPECT_EQ(0, schemaManager.AddSchema("Observation", hintSchema("integer", "DELTA_BINARY_PACKED")));
+    EXPECT_EQ(0, schemaManager.AddSchema("Observation", hintSchema("decimal", "BYTE_STREAM_SPLIT")));
+
+    // Hints the arrow version can't write yet.
+    EXPECT_EQ(ARROW_VERSION_MAJOR >= 12 ? 0 : 11001, schemaManager.AddSchema("Observation", hintSchema("boolean", "RLE")));
+    EXPECT_EQ(ARROW_VERSION_MAJOR >= 12 ? 0 : 11001, schemaManager.AddSchema("Observation", hintSchema("string", "DELTA_BYTE_ARRAY")));
+    EXPECT_EQ(ARROW_VERSION_MAJOR >= 16 ? 0 : 11001, schemaManager.AddSchema("Observation", hintSchema("integer", "BYTE_STREAM_SPLIT")));
+}
+
 TEST (SchemaTest, CheckStringIsEmptyOrWhiteSpace)
 {
     EXPECT_TRUE(IsEmptyOrWhitespace(string("")));
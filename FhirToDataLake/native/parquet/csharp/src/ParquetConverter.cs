@@ -36,7 +36,7 @@ namespace Microsoft.Health.Parquet
         private static extern int RegisterParquetSchema(IntPtr writer, string key, string value);
 
         [DllImport("ParquetNative")]
-        private static extern int TryReleaseUnmanagedData(ref IntPtr outBuffer);
+        private static extern int ReleaseParquetOutput(IntPtr writer, ref IntPtr outBuffer);
 
         [DllImport("ParquetNative")]
         private static extern int ConvertJsonToParquet(IntPtr writer, string key, [MarshalAs(UnmanagedType.LPUTF8Str)]string json, int inputSize, ref IntPtr outBuffer, out int outputSize, StringBuilder errorMessage);
@@ -57,19 +57,19 @@ namespace Microsoft.Health.Parquet
             int status = ConvertJsonToParquet(_nativeConverter, schemaType, inputJson, inputSize, ref outputPointer, out int outputSize, errorMessage);
             if (status != 0)
             {
-                TryReleaseUnmanagedData(ref outputPointer);
+                ReleaseParquetOutput(_nativeConverter, ref outputPointer);
                 throw new ParquetException(status, errorMessage.ToString());
             }
 
             if (outputPointer == IntPtr.Zero || outputSize == 0)
             {
-                TryReleaseUnmanagedData(ref outputPointer);
+                ReleaseParquetOutput(_nativeConverter, ref outputPointer);
                 return null;
             }
 
             byte[] outputBuffer = new byte[outputSize];
             Marshal.Copy(outputPointer, outputBuffer, 0, outputSize);
-            TryReleaseUnmanagedData(ref outputPointer);
+            ReleaseParquetOutput(_nativeConverter, ref outputPointer);
             return new MemoryStream(outputBuffer);
         }
 
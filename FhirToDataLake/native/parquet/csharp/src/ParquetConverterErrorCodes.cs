@@ -11,8 +11,24 @@ namespace Microsoft.Health.Parquet
 
         public const int WriteToParquetError = 10002;
 
+        public const int WriteToArrowError = 10003;
+
+        public const int ReadInputParquetError = 10004;
+
         public const int ParseParquetSchemaError = 11001;
 
         public const int SchemaNotFound = 11002;
+
+        public const int ConversionCancelled = 12001;
+
+        public const int TooManyInFlightConversions = 12002;
+
+        public const int ConversionJobNotFound = 12003;
+
+        public const int ConversionStatisticsNotFound = 13001;
+
+        public const int InvalidEncryptionKeys = 14001;
+
+        public const int PageChecksumNotSupported = 14002;
     }
 }